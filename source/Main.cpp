@@ -25,6 +25,41 @@ int main()
 	tt::Test001();
 	/********************* Test 002 :  ListEntry Basic Function and default constructor **********************/
 	
+	/********************* Test 026 :  latency histogram and per priority accounting **********************/
+	tt::Test026_latencyHistogram();
+	/********************* Bench 027 :  async timer bodies off the main thread **********************/
+	tt::Bench027_asyncTickTime();
+	/********************* Test 027 :  async cancellation and concurrency limit **********************/
+	tt::Test027_asyncCancelAndLimit();
+	/********************* Test 028 :  debounce and throttle edges **********************/
+	tt::Test028_debounceThrottle();
+	/********************* Bench 028 :  debounce re-arm in place **********************/
+	tt::Bench028_rearmCost();
+	/********************* Test 029 :  stats counters stay current **********************/
+	tt::Test029_statsCounters();
+	/********************* Bench 030 :  fast forward vs frame stepping **********************/
+	tt::Bench030_fastForward();
+	/********************* Test 030 :  finite repeats stop, same deadlines in both modes **********************/
+	tt::Test030_finiteRepeat();
+	/********************* Test 030 :  pause and resume during a fast forward **********************/
+	tt::Test030_fastForwardPauseResume();
+	/********************* Test 030 :  unschedule during a fast forward **********************/
+	tt::Test030_fastForwardUnschedule();
+	/********************* Test 031 :  lockstep replays bit-identically **********************/
+	tt::Test031_lockstepDeterminism();
+	/********************* Test 032 :  update batches **********************/
+	tt::Test032_updateBatch();
+	/********************* Test 033 :  teardown through the scheduler slots **********************/
+	tt::Test033_teardown();
+	/********************* Bench 033 :  level unload **********************/
+	tt::Bench033_teardown();
+	/********************* Test 034 :  lock free queries from worker threads **********************/
+	tt::Test034_concurrentQueries();
+	/********************* Test 034 :  isTargetScheduled after timers finish **********************/
+	tt::Test034_scheduledLifecycle();
+	/********************* Bench 034 :  query throughput across cores **********************/
+	tt::Bench034_queryThroughput();
+
 
 	return 0;
 }
@@ -1,5 +1,18 @@
 #include "core/Scheduler.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace tt {
 	static void showListEntry(cc::ListEntry* a) {
@@ -24,4 +37,899 @@ namespace tt {
 		a = cc::ListEntry::get(nullptr, cc::Priority::LOW, false, false);
 		delete a; delete b;
 	}
-}
\ No newline at end of file
+	// Histogram buckets tile the value range with under 12.5% error, percentiles stay within it,
+	// and fires are accounted to the priority they were scheduled with until the window is reset
+	static void Test026_latencyHistogram() {
+		using Histogram = cc::LatencyHistogram;
+		bool ok = true;
+		for (uint32_t i = 0; i < 2 * Histogram::SUB_BUCKET_COUNT; ++i) {
+			ok = ok && Histogram::bucketIndexOf(i) == i && Histogram::highestEquivalentOf(i) == i;
+		}
+		uint64_t lowest = 0;
+		for (uint32_t i = 0; ok && i < Histogram::BUCKET_COUNT; ++i) {
+			uint64_t highest = Histogram::highestEquivalentOf(i);
+			ok = Histogram::bucketIndexOf(static_cast<uint32_t>(lowest)) == i && Histogram::bucketIndexOf(static_cast<uint32_t>(highest)) == i;
+			ok = ok && (highest - lowest) * Histogram::SUB_BUCKET_COUNT <= std::max<uint64_t>(lowest, 1);
+			lowest = highest + 1;
+		}
+		ok = ok && lowest == 1ULL << 32;
+
+		// 1ms to 100ms, percentiles report the top of their bucket but never more than the max
+		Histogram histogram;
+		for (int ms = 1; ms <= 100; ++ms) {
+			histogram.record(static_cast<float>(ms) * 1e-3f);
+		}
+		auto near = [](float value, float expected) { return value >= expected * 0.999f && value <= expected * 1.125f; };
+		ok = ok && histogram.getCount() == 100 && near(histogram.getP50(), 0.05f) && near(histogram.getP99(), 0.099f) && near(histogram.getMax(), 0.1f);
+		ok = ok && histogram.getP99() <= histogram.getMax();
+		histogram.reset();
+		ok = ok && histogram.getCount() == 0 && histogram.getP50() == 0.f && histogram.getMax() == 0.f;
+
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		cc::ISchedulable target;
+		cc::Scheduler scheduler;
+		cc::ccSchedulerFunc noop = [](float dt) {};
+		scheduler.setLatencyTrackingEnabled(true);
+		scheduler.schedule(noop, &target, 1, repeatForever, 0);
+		scheduler.schedule(noop, &target, 2, repeatForever, 0, false, cc::Priority::HIGH);
+		scheduler.debounce(&target, "save", 0.5f, noop, cc::Priority::MEDIUM);
+		for (int frame = 0; frame < 8; ++frame) {
+			scheduler.update(0.75f);
+		}
+		// 6s: the 1s timer fired 6 times, the 2s one 3 times, each less than a frame late
+		const Histogram* low = scheduler.getLatencyHistogram(cc::Priority::LOW);
+		const Histogram* high = scheduler.getLatencyHistogram(cc::Priority::HIGH);
+		const Histogram* medium = scheduler.getLatencyHistogram(cc::Priority::MEDIUM);
+		ok = ok && low != nullptr && high != nullptr && medium != nullptr;
+		ok = ok && low->getCount() == 6 && high->getCount() == 3 && medium->getCount() == 1;
+		ok = ok && high->getMax() > 0.f && high->getMax() < 0.75f && low->getP99() <= low->getMax();
+		scheduler.resetLatencyWindow();
+		ok = ok && low->getCount() == 0 && high->getCount() == 0 && medium->getCount() == 0 && high->getMax() == 0.f;
+		std::cout << "Test026 latency histogram: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Main thread time per tick of 8 CPU heavy every frame timers, run inline vs as async timers,
+	// and wall time until every one of their bodies has run
+	static void Bench027_asyncTickTime() {
+		constexpr int ticks = 60;
+		constexpr int timerCount = 8;
+		std::atomic<uint64_t> sink{ 0 };
+		cc::ccSchedulerFunc heavy = [&sink](float dt) {
+			uint64_t h = 1469598103934665603ULL;
+			for (int i = 0; i < 200000; ++i) {
+				h = (h ^ static_cast<uint64_t>(i)) * 1099511628211ULL;
+			}
+			sink += h + static_cast<uint64_t>(dt);
+		};
+		using clock = std::chrono::steady_clock;
+		auto millis = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+		std::vector<cc::ISchedulable> targets(timerCount);
+		double inlineTick = 0;
+		{
+			cc::Scheduler scheduler;
+			for (auto& target : targets) {
+				scheduler.schedule(heavy, &target, 0, ticks - 1, 0);
+			}
+			auto start = clock::now();
+			for (int t = 0; t < ticks; ++t) {
+				scheduler.update(1.f / 60.f);
+			}
+			inlineTick = millis(clock::now() - start) / ticks;
+		}
+
+		double asyncTick = 0;
+		double asyncTotal = 0;
+		{
+			cc::Scheduler scheduler;
+			std::atomic<int> completions{ 0 };
+			cc::ccSchedulerFunc completion = [&completions](float dt) { completions += 1; };
+			for (auto& target : targets) {
+				scheduler.scheduleAsync(heavy, completion, &target, 0.f, ticks - 1, 0.f);
+			}
+			auto start = clock::now();
+			clock::duration ticking{};
+			for (int t = 0; t < ticks; ++t) {
+				auto tickStart = clock::now();
+				scheduler.update(1.f / 60.f);
+				ticking += clock::now() - tickStart;
+			}
+			// keep ticking until every completion came back, the timers are done so nothing new is posted
+			while (completions < ticks * timerCount) {
+				scheduler.update(1.f / 60.f);
+				std::this_thread::yield();
+			}
+			asyncTick = millis(ticking) / ticks;
+			asyncTotal = millis(clock::now() - start);
+		}
+		std::cout << "Bench027 main thread per tick, inline: " << inlineTick << "ms, async: " << asyncTick << "ms; all " << ticks * timerCount
+			<< " bodies done, inline: " << inlineTick * ticks << "ms, async: " << asyncTotal << "ms" << std::endl;
+	}
+	// Async bodies respect the concurrency limit, unscheduling drops queued bodies and their completions, one shot timers fire once
+	static void Test027_asyncCancelAndLimit() {
+		using clock = std::chrono::steady_clock;
+		auto waitFor = [](const std::function<bool()>& done) {
+			auto deadline = clock::now() + std::chrono::seconds(5);
+			while (!done() && clock::now() < deadline) {
+				std::this_thread::yield();
+			}
+			return done();
+		};
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		cc::ISchedulable gateA;
+		cc::ISchedulable gateB;
+		cc::ISchedulable victim;
+		cc::ISchedulable oneShot;
+		cc::Scheduler scheduler;
+		scheduler.setAsyncWorkerCount(2);
+
+		// both workers block on the gate, so the victim's body stays queued
+		std::atomic<bool> open{ false };
+		std::atomic<int> gateStarts{ 0 };
+		std::atomic<int> victimRuns{ 0 };
+		int gateCompletions = 0;
+		int victimCompletions = 0;
+		int oneShotCompletions = 0;
+		cc::ccSchedulerFunc gateBody = [&](float dt) {
+			gateStarts += 1;
+			while (!open) {
+				std::this_thread::yield();
+			}
+		};
+		scheduler.scheduleAsync(gateBody, [&](float dt) { gateCompletions += 1; }, &gateA, 0.f, repeatForever, 0.f);
+		scheduler.scheduleAsync(gateBody, [&](float dt) { gateCompletions += 1; }, &gateB, 0.f, repeatForever, 0.f);
+		scheduler.scheduleAsync([&](float dt) { victimRuns += 1; }, [&](float dt) { victimCompletions += 1; }, &victim, 0.f, repeatForever, 0.f);
+		scheduler.setAsyncConcurrencyLimit(&gateA, 1);
+		scheduler.setAsyncConcurrencyLimit(&gateB, 1);
+		scheduler.setAsyncConcurrencyLimit(&victim, 1);
+
+		bool ok = true;
+		for (int t = 0; t < 5; ++t) {
+			scheduler.update(1.f / 60.f);
+		}
+		ok = ok && waitFor([&]() { return gateStarts == 2; });
+		scheduler.unscheduleAllForTarget(&victim);
+		open = true;
+		// without ticking nothing new is posted, so only what was queued can run: one body per gate under the limit
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ok = ok && gateStarts == 2;
+		ok = ok && waitFor([&]() {
+			scheduler.update(1.f / 60.f);
+			return gateCompletions >= 6;
+		});
+		scheduler.unscheduleAllForTarget(&gateA);
+		scheduler.unscheduleAllForTarget(&gateB);
+		// one body in flight per gate at a time: every start but the two running now has completed
+		ok = ok && gateStarts <= gateCompletions + 2 && victimRuns == 0 && victimCompletions == 0;
+
+		scheduler.scheduleAsync([](float dt) {}, [&](float dt) { oneShotCompletions += 1; }, &oneShot, 0.1f, 0, 0.f);
+		for (int t = 0; t < 100; ++t) {
+			scheduler.update(1.f / 60.f);
+		}
+		ok = ok && waitFor([&]() {
+			scheduler.update(1.f / 60.f);
+			return oneShotCompletions > 0;
+		});
+		ok = ok && oneShotCompletions == 1;
+
+		// a one-shot whose body runs when its target is unscheduled is cancelled although its repeat ran out
+		std::atomic<bool> release{ false };
+		std::atomic<int> blockedStarts{ 0 };
+		int lateCompletions = 0;
+		cc::ccSchedulerFunc blocked = [&](float dt) {
+			blockedStarts += 1;
+			while (!release) {
+				std::this_thread::yield();
+			}
+		};
+		scheduler.scheduleAsync(blocked, [&](float dt) { lateCompletions += 1; }, &oneShot, 0.f, 0, 0.f);
+		ok = ok && waitFor([&]() {
+			scheduler.update(1.f / 60.f);
+			return blockedStarts == 1;
+		});
+		scheduler.unscheduleAllForTarget(&oneShot);
+		release = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		for (int t = 0; t < 5; ++t) {
+			scheduler.update(1.f / 60.f);
+		}
+		ok = ok && lateCompletions == 0;
+
+		// unscheduling clears the limit, the next target at the same address is not throttled by it
+		release = false;
+		blockedStarts = 0;
+		scheduler.setAsyncConcurrencyLimit(&oneShot, 1);
+		scheduler.unscheduleAllForTarget(&oneShot);
+		int unlimitedCompletions = 0;
+		scheduler.scheduleAsync(blocked, [&](float dt) { unlimitedCompletions += 1; }, &oneShot, 0.f, 0, 0.f);
+		scheduler.scheduleAsync(blocked, [&](float dt) { unlimitedCompletions += 1; }, &oneShot, 0.f, 0, 0.f);
+		scheduler.update(1.f / 60.f);
+		ok = ok && waitFor([&]() { return blockedStarts == 2; });
+		release = true;
+		// the bodies use locals declared after the scheduler, let them finish first
+		ok = ok && waitFor([&]() {
+			scheduler.update(1.f / 60.f);
+			return unlimitedCompletions == 2;
+		});
+		std::cout << "Test027 async cancel and limit (" << gateStarts << " gate bodies): " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Cost of moving a debounce deadline through the scheduler: unschedule and schedule again vs debounce re-arming in place,
+	// alone on its target and next to 256 other timers, which must not slow the re-arm down
+	static void Bench028_rearmCost() {
+		constexpr int rearms = 100000;
+		constexpr int otherTimers = 256;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		const std::string key = "debounce";
+		cc::ISchedulable recreated;
+		cc::ISchedulable alone;
+		cc::ISchedulable busy;
+		cc::Scheduler scheduler;
+		cc::ccSchedulerFunc callback = [](float dt) {};
+		for (int i = 0; i < otherTimers; ++i) {
+			scheduler.schedule(callback, &busy, 1, repeatForever, 0);
+		}
+		using clock = std::chrono::steady_clock;
+
+		auto start = clock::now();
+		for (int i = 0; i < rearms; ++i) {
+			scheduler.unscheduleAllForTarget(&recreated);
+			scheduler.schedule(callback, &recreated, 1, 0, 0);
+		}
+		auto recreateTime = std::chrono::duration<double, std::nano>(clock::now() - start).count() / rearms;
+
+		auto timeDebounce = [&](cc::ISchedulable* target) {
+			auto begin = clock::now();
+			for (int i = 0; i < rearms; ++i) {
+				scheduler.debounce(target, key, 0.2f, callback);
+			}
+			return std::chrono::duration<double, std::nano>(clock::now() - begin).count() / rearms;
+		};
+		double aloneTime = timeDebounce(&alone);
+		double busyTime = timeDebounce(&busy);
+		std::cout << "Bench028 per re-arm, unschedule + schedule: " << recreateTime << "ns, debounce: " << aloneTime << "ns, debounce next to "
+			<< otherTimers << " timers: " << busyTime << "ns" << std::endl;
+	}
+	// Debounce collapses calls into one trailing fire and can re-arm itself, throttle fires leading and trailing edges only
+	static void Test028_debounceThrottle() {
+		cc::ISchedulable collapsing;
+		cc::ISchedulable chained;
+		cc::ISchedulable throttled;
+		cc::ISchedulable paused;
+		cc::Scheduler scheduler;
+		scheduler.setLatencyTrackingEnabled(true);
+		cc::ccSchedulerFunc noop = [](float dt) {};
+		scheduler.schedule(noop, &paused, 100, 0, 0, true);
+		std::vector<uint32_t> leadingTriggers;
+		std::vector<std::string> fires;
+		auto record = [&](const std::string& what) {
+			return [&, what](float dt) { fires.push_back(what + "@" + std::to_string(scheduler.getCurrentTime())); };
+		};
+		int chainedFires = 0;
+		cc::ccSchedulerFunc chain = [&](float dt) {
+			fires.push_back("chained@" + std::to_string(scheduler.getCurrentTime()));
+			if (++chainedFires < 3) {
+				scheduler.debounce(&chained, "chain", 0.5f, chain);
+			}
+		};
+
+		// frames of 1/8s, each call below happens before the frame starting at that time
+		for (int frame = 0; frame < 32; ++frame) {
+			double now = frame * 0.125;
+			if (now == 0.0 || now == 0.25 || now == 0.5) {
+				scheduler.debounce(&collapsing, "k", 0.5f, record("debounce"));
+			}
+			if (now == 0.0) {
+				scheduler.debounce(&chained, "chain", 0.5f, chain);
+				scheduler.throttle(&throttled, "k", 0.5f, record("leading"));
+			}
+			if (now == 0.125) {
+				scheduler.throttle(&throttled, "k", 0.5f, record("collapsed"));
+			}
+			if (now == 0.25) {
+				scheduler.throttle(&throttled, "k", 0.5f, record("trailing"));
+			}
+			if (now == 2.0) {
+				scheduler.throttle(&throttled, "k", 0.5f, record("leading"));
+			}
+			// a paused target does not call back, its leading edge waits for the first update after resume
+			if (now == 0.5) {
+				scheduler.throttle(&paused, "k", 0.5f, record("resumed"));
+			}
+			if (now == 1.25) {
+				scheduler.resumeTarget(&paused);
+			}
+			scheduler.update(0.125f);
+			// leading edges called between updates count in the next one, alone in their frame
+			if (now == 0.0 || now == 2.0) {
+				leadingTriggers.push_back(scheduler.stats().triggersPerUpdate);
+			}
+		}
+
+		std::vector<std::string> expected{ "leading@0.000000", "chained@0.500000", "trailing@0.500000", "debounce@1.000000",
+			"chained@1.000000", "resumed@1.375000", "chained@1.500000", "leading@2.000000" };
+		// only the fires which called back are counted, idle throttle windows are not
+		const cc::LatencyHistogram* latency = scheduler.getLatencyHistogram(cc::Priority::LOW);
+		bool ok = fires == expected && latency != nullptr && latency->getCount() == expected.size();
+		ok = ok && leadingTriggers == std::vector<uint32_t>{ 1, 1 };
+		std::cout << "Test028 debounce and throttle (" << fires.size() << " fires): " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Stats counters follow schedule, pause and unschedule calls without a tick, and entries come back from the pools
+	static void Test029_statsCounters() {
+		cc::ISchedulable first;
+		cc::ISchedulable middle;
+		cc::ISchedulable last;
+		cc::ISchedulable ticking;
+		cc::ISchedulable once;
+		cc::Scheduler scheduler;
+		int firstUpdates = 0;
+		int middleUpdates = 0;
+		int lateUpdates = 0;
+		cc::ccSchedulerFunc noop = [](float dt) {};
+		cc::ccSchedulerFunc late = [&](float dt) { lateUpdates += 1; };
+		cc::ccSchedulerFunc countFirst = [&](float dt) { firstUpdates += 1; };
+		cc::ccSchedulerFunc countMiddle = [&](float dt) {
+			// scheduled during the tick, runs from the next one
+			if (middleUpdates++ == 0) {
+				scheduler.scheduleUpdate(late, &last, cc::Priority::HIGH);
+			}
+		};
+		scheduler.scheduleUpdate(countFirst, &first, cc::Priority::SCHEDULER);
+		scheduler.scheduleUpdate(countMiddle, &middle, cc::Priority::LOW, true);
+		scheduler.scheduleUpdate(noop, &last, cc::Priority::MEDIUM);
+		scheduler.schedule(noop, &ticking, 1, UINT_MAX - 1, 0);
+		scheduler.schedule(noop, &ticking, 2, UINT_MAX - 1, 0);
+		scheduler.schedule(noop, &once, 1, 0, 0);
+
+		cc::SchedulerStats stats = scheduler.stats();
+		bool ok = stats.updatesNeg.entries == 1 && stats.updates0.entries == 1 && stats.updates0.paused == 1 && stats.updatesPos.entries == 1;
+		ok = ok && stats.timers == 3 && stats.timerTargets == 2 && stats.pausedTimerTargets == 0;
+
+		scheduler.pauseTarget(&first);
+		scheduler.pauseTarget(&ticking);
+		scheduler.pauseTarget(&ticking);
+		scheduler.resumeTarget(&middle);
+		stats = scheduler.stats();
+		ok = ok && stats.updatesNeg.paused == 1 && stats.updates0.paused == 0 && stats.pausedTimerTargets == 1;
+
+		// unscheduled entries are waiting for the sweep but no longer counted
+		scheduler.unscheduleUpdate(&last);
+		scheduler.unscheduleAllForTarget(&ticking);
+		stats = scheduler.stats();
+		ok = ok && stats.updatesPos.entries == 0 && stats.timers == 1 && stats.timerTargets == 1 && stats.pausedTimerTargets == 0;
+
+		// the one-shot fires and is removed, the update entries come from the pools the sweep refilled
+		uint64_t listHits = stats.listEntryPool.hits;
+		uint64_t hashHits = stats.hashUpdateEntryPool.hits;
+		scheduler.update(1.5f);
+		stats = scheduler.stats();
+		ok = ok && stats.timers == 0 && stats.timerTargets == 0 && stats.updatesPos.entries == 1;
+		ok = ok && stats.listEntryPool.hits > listHits && stats.hashUpdateEntryPool.hits > hashHits;
+		scheduler.update(0.5f);
+		ok = ok && firstUpdates == 0 && middleUpdates == 2 && lateUpdates == 1;
+
+		// another priority moves the entry to another list
+		scheduler.scheduleUpdate(noop, &first, cc::Priority::LOW);
+		stats = scheduler.stats();
+		ok = ok && stats.updatesNeg.entries == 0 && stats.updatesNeg.paused == 0 && stats.updates0.entries == 2 && stats.updates0.paused == 0;
+
+		// triggers add up over the lockstep steps of one update, an update running no step reports none
+		cc::ISchedulable stepped;
+		cc::Scheduler lockstep;
+		lockstep.setLockstep(0.1f, 4);
+		lockstep.schedule(noop, &stepped, 0, UINT_MAX - 1, 0);
+		lockstep.update(0.35f);
+		ok = ok && lockstep.stats().triggersPerUpdate == 3;
+		lockstep.update(0.01f);
+		stats = lockstep.stats();
+		ok = ok && stats.triggersPerUpdate == 0;
+		for (float seconds : stats.phaseSeconds) {
+			ok = ok && seconds == 0;
+		}
+		std::cout << "Test029 stats counters: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Ten simulated minutes of 1000 periodic timers: frame stepping vs jumping between deadlines.
+	// Frames are 1/64s, exact in binary, so both runs reach every deadline and must count the same fires
+	static void Bench030_fastForward() {
+		constexpr int targetCount = 1000;
+		constexpr double duration = 600.0;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		using clock = std::chrono::steady_clock;
+
+		auto run = [&](bool fastForward, uint64_t& fires) {
+			// targets must outlive their schedule
+			std::vector<cc::ISchedulable> targets(targetCount);
+			cc::Scheduler scheduler;
+			cc::ccSchedulerFunc callback = [&fires](float dt) { fires += 1; };
+			for (int i = 0; i < targetCount; ++i) {
+				scheduler.schedule(callback, &targets[i], 1 + i % 4, repeatForever, 0);
+			}
+			auto start = clock::now();
+			if (fastForward) {
+				scheduler.fastForward(duration);
+			} else {
+				while (scheduler.getCurrentTime() < duration) {
+					scheduler.update(1.f / 64.f);
+				}
+			}
+			return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		};
+
+		uint64_t steppedFires = 0;
+		uint64_t fastFires = 0;
+		double steppedTime = run(false, steppedFires);
+		double fastTime = run(true, fastFires);
+		std::cout << "Bench030 600s of 1000 timers, frame stepping: " << steppedTime << "ms (" << steppedFires << " fires), fast forward: "
+			<< fastTime << "ms (" << fastFires << " fires)" << std::endl;
+	}
+	// Finite repeats stop and the first deadline is `delay` or `interval` after scheduling, frame stepped or fast forwarded
+	static void Test030_finiteRepeat() {
+		auto run = [](bool fastForward) {
+			cc::ISchedulable once;
+			cc::ISchedulable thrice;
+			cc::Scheduler scheduler;
+			std::vector<double> onceFires;
+			std::vector<double> thriceFires;
+			cc::ccSchedulerFunc recordOnce = [&](float dt) { onceFires.push_back(scheduler.getCurrentTime()); };
+			cc::ccSchedulerFunc recordThrice = [&](float dt) { thriceFires.push_back(scheduler.getCurrentTime()); };
+			scheduler.schedule(recordOnce, &once, 1, 0, 0);
+			scheduler.schedule(recordThrice, &thrice, 2, 2, 1);
+			if (fastForward) {
+				scheduler.fastForward(10.0);
+			} else {
+				while (scheduler.getCurrentTime() < 10.0) {
+					scheduler.update(0.25f);
+				}
+			}
+			bool unscheduled = !scheduler.isTargetScheduled(&once) && !scheduler.isTargetScheduled(&thrice) && scheduler.stats().timers == 0;
+			return onceFires == std::vector<double>{ 1.0 } && thriceFires == std::vector<double>{ 1.0, 3.0, 5.0 } && unscheduled;
+		};
+		bool ok = run(false) && run(true);
+		std::cout << "Test030 finite repeat: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// A timer paused and resumed during a fast forward fires once per interval, shifted by the paused time
+	static void Test030_fastForwardPauseResume() {
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		cc::ISchedulable paused;
+		cc::ISchedulable controller;
+		cc::Scheduler scheduler;
+		std::vector<double> fires;
+		int controllerFires = 0;
+		cc::ccSchedulerFunc record = [&](float dt) { fires.push_back(scheduler.getCurrentTime()); };
+		cc::ccSchedulerFunc toggle = [&](float dt) {
+			controllerFires += 1;
+			if (controllerFires == 1) {
+				scheduler.pauseTarget(&paused);
+			} else if (controllerFires == 2) {
+				scheduler.resumeTarget(&paused);
+			}
+		};
+		scheduler.schedule(record, &paused, 10, repeatForever, 0);
+		scheduler.schedule(toggle, &controller, 3, repeatForever, 0);
+		scheduler.fastForward(40.0);
+
+		// paused from 3 to 6, so due at 13, 23 and 33 instead of 10, 20 and 30
+		const std::vector<double> expected{ 13.0, 23.0, 33.0 };
+		bool ok = fires.size() == expected.size();
+		for (size_t i = 0; ok && i < fires.size(); ++i) {
+			ok = std::abs(fires[i] - expected[i]) < 1e-3;
+		}
+		std::cout << "Test030 fast forward pause and resume (" << fires.size() << " fires): " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Every frame timers stop when their target is unscheduled during a fixed step fast forward,
+	// and pausing a target from a callback does not make the other every frame timers skip a step
+	static void Test030_fastForwardUnschedule() {
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		cc::ISchedulable paused;
+		cc::ISchedulable pauser;
+		cc::ISchedulable bystander;
+		cc::ISchedulable doomed;
+		cc::ISchedulable controller;
+		cc::Scheduler scheduler;
+		int pauserFires = 0;
+		int bystanderFires = 0;
+		int doomedFires = 0;
+		cc::ccSchedulerFunc noop = [](float dt) {};
+		cc::ccSchedulerFunc pause = [&](float dt) {
+			if (++pauserFires == 4) {
+				scheduler.pauseTarget(&paused);
+			}
+		};
+		cc::ccSchedulerFunc countBystander = [&](float dt) { bystanderFires += 1; };
+		cc::ccSchedulerFunc countDoomed = [&](float dt) { doomedFires += 1; };
+		cc::ccSchedulerFunc unschedule = [&](float dt) { scheduler.unscheduleAllForTarget(&doomed); };
+		scheduler.schedule(noop, &paused, 0, repeatForever, 0);
+		scheduler.schedule(pause, &pauser, 0, repeatForever, 0);
+		scheduler.schedule(countBystander, &bystander, 0, repeatForever, 0);
+		scheduler.schedule(countDoomed, &doomed, 0, repeatForever, 0);
+		scheduler.schedule(unschedule, &controller, 1, 0, 0);
+		scheduler.fastForward(3.0, 0.125f);
+
+		// 24 steps, the unschedule fires at 1s among the timers of step 8, before its every frame timers
+		bool ok = pauserFires == 24 && bystanderFires == 24 && doomedFires == 7;
+		ok = ok && !scheduler.isTargetScheduled(&doomed) && scheduler.isTargetPaused(&paused) && scheduler.stats().timers == 3;
+		std::cout << "Test030 fast forward unschedule (" << doomedFires << " fires of the target unscheduled at 1s): " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Same schedule calls, different frame dt and target addresses: the lockstep trace must be bit-identical
+	static void Test031_lockstepDeterminism() {
+		constexpr int targetCount = 64;
+		constexpr uint64_t tickLimit = 3000;
+
+		auto run = [&](uint32_t seed, bool reverseAllocation) {
+			std::vector<std::unique_ptr<cc::ISchedulable>> targets(targetCount);
+			for (int n = 0; n < targetCount; ++n) {
+				int i = reverseAllocation ? targetCount - 1 - n : n;
+				targets[i] = std::make_unique<cc::ISchedulable>();
+				targets[i]->id = std::to_string(i);
+			}
+
+			cc::Scheduler scheduler;
+			scheduler.setLockstep(1.f / 30.f, 4);
+			std::vector<std::string> trace;
+			auto record = [&](const std::string& what, float dt) {
+				if (scheduler.getLockstepTick() >= tickLimit) {
+					return;
+				}
+				uint32_t bits = 0;
+				std::memcpy(&bits, &dt, sizeof(bits));
+				trace.push_back(std::to_string(scheduler.getLockstepTick()) + ":" + what + ":" + std::to_string(bits));
+			};
+			for (int i = 0; i < targetCount; ++i) {
+				cc::ISchedulable* target = targets[i].get();
+				cc::ccSchedulerFunc callback = [&, target](float dt) {
+					record("timer" + target->id, dt);
+					scheduler.debounce(target, "settle", 0.25f, [&, target](float d) { record("debounce" + target->id, d); });
+				};
+				scheduler.schedule(callback, target, 1 + i % 3, UINT_MAX - 1, i % 2);
+			}
+
+			std::mt19937 random(seed);
+			std::uniform_real_distribution<float> frame(0.001f, 0.2f);
+			while (scheduler.getLockstepTick() < tickLimit) {
+				scheduler.update(frame(random));
+			}
+			return trace;
+		};
+
+		auto first = run(1, false);
+		auto replay = run(1, false);
+		auto otherFrames = run(7, true);
+		bool ok = !first.empty() && first == replay && first == otherFrames;
+		std::cout << "Test031 lockstep determinism (" << first.size() << " fires): " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Update batches: swap remove keeps handles valid, adds and removes during the callback are deferred,
+	// owners take their items along when unscheduled and batches run among the update entries by priority
+	static void Test032_updateBatch() {
+		struct Particle {
+			int   id;
+			float x;
+		};
+		cc::ISchedulable owner;
+		cc::ISchedulable clock;
+		cc::Scheduler scheduler;
+		std::vector<int> seen;
+		cc::UpdateBatchHandle added;
+		cc::UpdateBatch<Particle>* batch = nullptr;
+		std::vector<cc::UpdateBatchHandle> handles;
+		batch = scheduler.scheduleUpdateBatch<Particle>(cc::Priority::LOW, [&](cc::UpdateSpan<Particle> items, float dt) {
+			seen.clear();
+			for (Particle& particle : items) {
+				particle.x += dt;
+				seen.push_back(particle.id);
+			}
+			if (!batch->contains(added)) {
+				added = batch->add(nullptr, Particle{ 9, 0.f });
+				batch->remove(handles[0]);
+				batch->remove(handles[0]);
+			}
+		});
+		for (int id = 0; id < 4; ++id) {
+			handles.push_back(batch->add(id < 2 ? &owner : nullptr, Particle{ id, 0.f }));
+		}
+
+		// removal moves the last item into the hole, the handles follow their items
+		batch->remove(handles[1]);
+		batch->remove(handles[1]);
+		bool ok = batch->size() == 3 && !batch->contains(handles[1]) && batch->get(handles[3])->id == 3 && owner._schedulerSlot.batchEntries == 1;
+		cc::UpdateBatchHandle reused = batch->add(nullptr, Particle{ 4, 0.f });
+		ok = ok && reused.slot == handles[1].slot && !batch->contains(handles[1]) && batch->get(reused)->id == 4;
+
+		// the callback sees the items as they were when it started, its add and remove apply right after it
+		scheduler.update(0.5f);
+		ok = ok && seen == std::vector<int>{ 0, 3, 2, 4 } && batch->size() == 4 && !batch->contains(handles[0]) && batch->get(added)->id == 9;
+		ok = ok && owner._schedulerSlot.batchEntries == 0 && batch->get(handles[3])->x == 0.5f;
+		// adds apply before removes, so 9 took the place of 0
+		scheduler.update(0.5f);
+		ok = ok && seen == std::vector<int>{ 9, 3, 2, 4 } && batch->get(handles[3])->x == 1.f;
+
+		// unscheduling the owner removes its items
+		cc::UpdateBatchHandle owned = batch->add(&owner, Particle{ 5, 0.f });
+		scheduler.unscheduleAllForTarget(&owner);
+		ok = ok && !batch->contains(owned) && owner._schedulerSlot.batchEntries == 0 && batch->size() == 4;
+
+		// batches run after the entries of the same priority, SCHEDULER is the lowest
+		std::string order;
+		cc::ISchedulable first;
+		cc::ISchedulable low;
+		cc::ISchedulable high;
+		scheduler.unscheduleUpdateBatch(batch);
+		auto record = [&](const char* name) { return [&order, name](float dt) { order += name; }; };
+		scheduler.scheduleUpdate(record("L"), &low, cc::Priority::LOW);
+		scheduler.scheduleUpdate(record("H"), &high, cc::Priority::HIGH);
+		scheduler.scheduleUpdate(record("S"), &first, cc::Priority::SCHEDULER);
+		for (auto pair : { std::make_pair(cc::Priority::MEDIUM, "m"), std::make_pair(cc::Priority::SCHEDULER, "s"),
+						   std::make_pair(cc::Priority::HIGH, "h"), std::make_pair(cc::Priority::LOW, "l") }) {
+			const char* name = pair.second;
+			auto* other = scheduler.scheduleUpdateBatch<Particle>(pair.first, [&order, name](cc::UpdateSpan<Particle> items, float dt) { order += name; });
+			other->add(nullptr, Particle{ 0, 0.f });
+		}
+		scheduler.update(0.5f);
+		ok = ok && order == "SsLlmHh";
+
+		// unscheduled by a timer, the batch no longer runs and is gone by the end of the update
+		int runs = 0;
+		auto* timed = scheduler.scheduleUpdateBatch<Particle>(cc::Priority::HIGH, [&](cc::UpdateSpan<Particle> items, float dt) { runs += 1; });
+		timed->add(&owner, Particle{ 0, 0.f });
+		cc::ccSchedulerFunc drop = [&](float dt) { scheduler.unscheduleUpdateBatch(timed); };
+		scheduler.schedule(drop, &clock, 0, 0, 0);
+		scheduler.update(0.5f);
+		ok = ok && runs == 1 && owner._schedulerSlot.batchEntries == 0;
+		scheduler.update(0.5f);
+		ok = ok && runs == 1;
+		std::cout << "Test032 update batch: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Teardown through the scheduler slots: bulk, one target at a time, from inside a callback during a tick,
+	// and the update entry on its own; stats and isTargetScheduled agree with the slots afterwards
+	static void Test033_teardown() {
+		constexpr int targetCount = 64;
+		constexpr int half = targetCount / 2;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		std::vector<cc::ISchedulable> targets(targetCount);
+		cc::ISchedulable unloader;
+		cc::Scheduler scheduler;
+		int fires = 0;
+		cc::ccSchedulerFunc count = [&](float dt) { fires += 1; };
+		for (int i = 0; i < targetCount; ++i) {
+			scheduler.schedule(count, &targets[i], 1, repeatForever, 0, i % 4 == 0);
+			scheduler.scheduleUpdate(count, &targets[i], i % 2 == 0 ? cc::Priority::LOW : cc::Priority::MEDIUM, i % 3 == 0);
+		}
+		auto isTornDown = [&](cc::ISchedulable& target) {
+			return !scheduler.isTargetScheduled(&target) && !scheduler.isTargetPaused(&target)
+				&& target._schedulerSlot.timers == nullptr && target._schedulerSlot.update == nullptr;
+		};
+		auto isEmpty = [](const cc::SchedulerStats& stats) {
+			return stats.timers == 0 && stats.timerTargets == 0 && stats.pausedTimerTargets == 0 && stats.updates0.entries == 0
+				&& stats.updates0.paused == 0 && stats.updatesPos.entries == 0 && stats.updatesPos.paused == 0;
+		};
+
+		// the update entry goes on its own, the timers keep the target scheduled
+		scheduler.unscheduleUpdate(&targets[0]);
+		bool ok = targets[0]._schedulerSlot.update == nullptr && scheduler.isTargetScheduled(&targets[0]) && scheduler.isTargetPaused(&targets[0]);
+		scheduler.unscheduleUpdate(&targets[0]);
+		ok = ok && scheduler.stats().updates0.entries == half - 1;
+
+		// bulk teardown of the first half
+		std::vector<cc::ISchedulable*> firstHalf;
+		for (int i = 0; i < half; ++i) {
+			firstHalf.push_back(&targets[i]);
+		}
+		scheduler.unscheduleAllForTargets(firstHalf.data(), firstHalf.size());
+		cc::SchedulerStats stats = scheduler.stats();
+		ok = ok && stats.timers == half && stats.timerTargets == half && stats.updates0.entries + stats.updatesPos.entries == half;
+		for (int i = 0; i < targetCount; ++i) {
+			ok = ok && isTornDown(targets[i]) == (i < half);
+		}
+
+		// the rest goes one target at a time from the first update callback of a tick, none of them runs any more
+		cc::ccSchedulerFunc unload = [&](float dt) {
+			for (int i = half; i < targetCount; ++i) {
+				scheduler.unscheduleAllForTarget(&targets[i]);
+			}
+			scheduler.unscheduleAllForTarget(&unloader);
+		};
+		scheduler.scheduleUpdate(unload, &unloader, cc::Priority::SCHEDULER);
+		scheduler.update(1.5f);
+		ok = ok && fires == 0 && isEmpty(scheduler.stats()) && isTornDown(unloader);
+		for (auto& target : targets) {
+			ok = ok && isTornDown(target);
+		}
+
+		// torn down targets can be scheduled again
+		scheduler.schedule(count, &targets[0], 1, 0, 0);
+		scheduler.scheduleUpdate(count, &targets[1], cc::Priority::LOW);
+		scheduler.update(1.5f);
+		ok = ok && fires == 2 && isTornDown(targets[0]) && scheduler.isTargetScheduled(&targets[1]);
+		std::cout << "Test033 teardown: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Level unload of 100k targets with a timer and an update entry each: one unscheduleAllForTarget per target,
+	// one unscheduleAllForTargets call, and one per target from inside an update callback during a tick
+	static void Bench033_teardown() {
+		constexpr int targetCount = 100000;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		using clock = std::chrono::steady_clock;
+
+		auto run = [&](int mode) {
+			std::vector<cc::ISchedulable> targets(targetCount);
+			cc::ISchedulable unloader;
+			cc::Scheduler scheduler;
+			cc::ccSchedulerFunc callback = [](float dt) {};
+			for (int i = 0; i < targetCount; ++i) {
+				scheduler.schedule(callback, &targets[i], 1 + i % 4, repeatForever, 0);
+				scheduler.scheduleUpdate(callback, &targets[i], i % 2 == 0 ? cc::Priority::LOW : cc::Priority::MEDIUM);
+			}
+			cc::ccSchedulerFunc unload = [&](float dt) {
+				for (auto& target : targets) {
+					scheduler.unscheduleAllForTarget(&target);
+				}
+				scheduler.unscheduleAllForTarget(&unloader);
+			};
+			std::vector<cc::ISchedulable*> all;
+			for (auto& target : targets) {
+				all.push_back(&target);
+			}
+			if (mode == 2) {
+				scheduler.scheduleUpdate(unload, &unloader, cc::Priority::SCHEDULER);
+			}
+
+			auto start = clock::now();
+			if (mode == 0) {
+				for (auto& target : targets) {
+					scheduler.unscheduleAllForTarget(&target);
+				}
+			} else if (mode == 1) {
+				scheduler.unscheduleAllForTargets(all.data(), all.size());
+			} else {
+				scheduler.update(0.016f);
+			}
+			double time = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+			return scheduler.stats().timers == 0 ? time : -1.0;
+		};
+
+		double oneByOne = run(0);
+		double bulk = run(1);
+		double inTick = run(2);
+		std::cout << "Bench033 teardown of 100000 targets, one at a time: " << oneByOne << "ms, bulk: " << bulk
+			<< "ms, one at a time during a tick: " << inTick << "ms" << std::endl;
+	}
+	// Worker threads query target state while the scheduler thread churns it; run under -fsanitize=thread
+	static void Test034_concurrentQueries() {
+		constexpr int churnCount = 256;
+		constexpr int ticks = 20000;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		const int readerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		std::vector<cc::ISchedulable> churn(churnCount);
+		cc::ISchedulable pinned;
+		cc::ISchedulable never;
+		cc::Scheduler scheduler;
+		cc::ccSchedulerFunc callback = [](float dt) {};
+		scheduler.schedule(callback, &pinned, 1, repeatForever, 0);
+		scheduler.setTimeScale(0.5f);
+
+		std::atomic<bool> running{ true };
+		std::atomic<bool> failed{ false };
+		std::atomic<uint64_t> reads{ 0 };
+		std::vector<std::thread> readers;
+		for (int r = 0; r < readerCount; ++r) {
+			readers.emplace_back([&, r]() {
+				uint64_t count = 0;
+				while (running.load(std::memory_order_relaxed)) {
+					// one load sees both flags of the same publish, a target is never paused without being scheduled
+					uint32_t state = churn[(r + count) % churnCount]._schedulerSlot.state.load(std::memory_order_acquire);
+					if ((state & cc::SchedulerSlot::PAUSED) != 0 && (state & cc::SchedulerSlot::SCHEDULED) == 0) {
+						failed = true;
+					}
+					float timeScale = scheduler.getTimeScale();
+					if (!scheduler.isTargetScheduled(&pinned) || scheduler.isTargetPaused(&pinned) || scheduler.isTargetScheduled(&never) || (timeScale != 0.5f && timeScale != 2.f)) {
+						failed = true;
+					}
+					count += 1;
+				}
+				reads += count;
+			});
+		}
+
+		std::mt19937 random(34);
+		for (int t = 0; t < ticks; ++t) {
+			for (int k = 0; k < 8; ++k) {
+				cc::ISchedulable* target = &churn[random() % churnCount];
+				switch (random() % 7) {
+				case 0: scheduler.schedule(callback, target, 1 + random() % 3, repeatForever, 0, random() % 2 == 0); break;
+				case 1: scheduler.schedule(callback, target, 0, 0, 0); break;
+				case 2: scheduler.scheduleUpdate(callback, target, cc::Priority::LOW, random() % 2 == 0); break;
+				case 3: scheduler.unscheduleUpdate(target); break;
+				case 4: scheduler.pauseTarget(target); break;
+				case 5: scheduler.resumeTarget(target); break;
+				default: scheduler.unscheduleAllForTarget(target); break;
+				}
+			}
+			scheduler.setTimeScale(t % 2 == 0 ? 2.f : 0.5f);
+			scheduler.update(0.016f);
+		}
+		running = false;
+		for (auto& reader : readers) {
+			reader.join();
+		}
+
+		// once the writer is quiet every reader sees exactly what the scheduler thread sees
+		for (auto& target : churn) {
+			const cc::SchedulerSlot& slot = target._schedulerSlot;
+			bool scheduled = slot.timers != nullptr || slot.update != nullptr;
+			bool paused = (slot.timers != nullptr && slot.timers->_paused) || (slot.update != nullptr && slot.update->_entry->_paused);
+			if (scheduler.isTargetScheduled(&target) != scheduled || scheduler.isTargetPaused(&target) != paused) {
+				failed = true;
+			}
+		}
+		std::cout << "Test034 concurrent queries (" << readerCount << " readers, " << reads << " reads): " << (failed ? "FAILED" : "OK") << std::endl;
+	}
+	// isTargetScheduled follows the timers: finished ones are removed, idle debounce and throttle timers are kept
+	static void Test034_scheduledLifecycle() {
+		cc::ISchedulable once;
+		cc::ISchedulable twice;
+		cc::ISchedulable rearmed;
+		cc::ISchedulable updated;
+		cc::Scheduler scheduler;
+		cc::ccSchedulerFunc noop = [](float dt) {};
+		scheduler.schedule(noop, &once, 1, 0, 0);
+		scheduler.schedule(noop, &twice, 1, 1, 0);
+		scheduler.debounce(&rearmed, "save", 0.5f, noop);
+		scheduler.throttle(&rearmed, "scroll", 0.5f, noop);
+		scheduler.scheduleUpdate(noop, &updated, cc::Priority::LOW, true);
+		bool ok = scheduler.isTargetScheduled(&once) && scheduler.isTargetScheduled(&twice) && scheduler.isTargetScheduled(&rearmed);
+		ok = ok && scheduler.isTargetScheduled(&updated) && scheduler.isTargetPaused(&updated);
+
+		scheduler.update(1.5f);
+		ok = ok && !scheduler.isTargetScheduled(&once) && scheduler.isTargetScheduled(&twice) && scheduler.isTargetScheduled(&rearmed);
+		scheduler.update(1.f);
+		ok = ok && !scheduler.isTargetScheduled(&twice) && scheduler.isTargetScheduled(&rearmed) && scheduler.stats().timers == 2;
+
+		scheduler.unscheduleAllForTarget(&rearmed);
+		scheduler.unscheduleUpdate(&updated);
+		ok = ok && !scheduler.isTargetScheduled(&rearmed) && !scheduler.isTargetScheduled(&updated) && !scheduler.isTargetPaused(&updated);
+		std::cout << "Test034 scheduled lifecycle: " << (ok ? "OK" : "FAILED") << std::endl;
+	}
+	// Lock free query throughput with the scheduler thread updating 10000 timers meanwhile
+	static void Bench034_queryThroughput() {
+		constexpr int targetCount = 10000;
+		constexpr uint64_t readsPerThread = 2000000;
+		constexpr uint32_t repeatForever = UINT_MAX - 1;
+		using clock = std::chrono::steady_clock;
+
+		std::vector<cc::ISchedulable> targets(targetCount);
+		cc::Scheduler scheduler;
+		cc::ccSchedulerFunc callback = [](float dt) {};
+		for (int i = 0; i < targetCount; ++i) {
+			scheduler.schedule(callback, &targets[i], 1 + i % 4, repeatForever, 0, i % 3 == 0);
+		}
+
+		std::atomic<bool> running{ true };
+		std::thread updater([&]() {
+			while (running.load(std::memory_order_relaxed)) {
+				scheduler.update(0.016f);
+			}
+		});
+		std::cout << "Bench034 reads/s while updating:";
+		unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+			std::atomic<uint64_t> sink{ 0 };
+			std::vector<std::thread> readers;
+			auto start = clock::now();
+			for (unsigned r = 0; r < threadCount; ++r) {
+				readers.emplace_back([&, r]() {
+					uint64_t hits = 0;
+					for (uint64_t i = 0; i < readsPerThread; ++i) {
+						cc::ISchedulable* target = &targets[(r * 7919 + i) % targetCount];
+						hits += scheduler.isTargetScheduled(target) + scheduler.isTargetPaused(target);
+					}
+					sink += hits;
+				});
+			}
+			for (auto& reader : readers) {
+				reader.join();
+			}
+			double seconds = std::chrono::duration<double>(clock::now() - start).count();
+			std::cout << " " << threadCount << "T " << static_cast<double>(readsPerThread * 2 * threadCount) / seconds / 1e6 << "M";
+		}
+		std::cout << std::endl;
+		running = false;
+		updater.join();
+	}
+}
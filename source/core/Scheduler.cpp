@@ -23,6 +23,13 @@
  THE SOFTWARE.
 ****************************************************************************/
 #include "core/Scheduler.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <iostream>
 namespace {
 constexpr uint32_t CC_REPEAT_FOREVER{UINT_MAX - 1};
@@ -33,6 +40,69 @@ constexpr uint32_t MAX_POOL_SIZE{ 20 };
 
 namespace cc {
 
+    /***** LatencyHistogram *****/
+
+    uint32_t LatencyHistogram::bucketIndexOf(uint32_t micros) {
+        // values below 2 * SUB_BUCKET_COUNT are exact, above that each power of two keeps SUB_BUCKET_COUNT buckets
+        uint32_t shift = 0;
+        while ((micros >> shift) >= 2 * SUB_BUCKET_COUNT) {
+            shift += 1;
+        }
+        if (shift == 0) {
+            return micros;
+        }
+        return (shift + 1) * SUB_BUCKET_COUNT + ((micros >> shift) - SUB_BUCKET_COUNT);
+    }
+
+    uint32_t LatencyHistogram::highestEquivalentOf(uint32_t index) {
+        if (index < 2 * SUB_BUCKET_COUNT) {
+            return index;
+        }
+        uint32_t shift = index / SUB_BUCKET_COUNT - 1;
+        uint64_t lowest = static_cast<uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+        return static_cast<uint32_t>(lowest + (1ULL << shift) - 1);
+    }
+
+    void LatencyHistogram::record(float lateness) {
+        double micros = static_cast<double>(lateness) * 1e6;
+        uint32_t value = 0;
+        if (micros >= static_cast<double>(UINT_MAX)) {
+            value = UINT_MAX;
+        } else if (micros > 0.0) {
+            value = static_cast<uint32_t>(micros);
+        }
+        _buckets[bucketIndexOf(value)] += 1;
+        _count += 1;
+        if (value > _maxMicros) {
+            _maxMicros = value;
+        }
+    }
+
+    void LatencyHistogram::reset() {
+        std::fill(std::begin(_buckets), std::end(_buckets), 0);
+        _count = 0;
+        _maxMicros = 0;
+    }
+
+    float LatencyHistogram::getPercentile(float percentile) const {
+        if (_count == 0) {
+            return 0.F;
+        }
+        auto rank = static_cast<uint64_t>(std::ceil(static_cast<double>(percentile) * static_cast<double>(_count)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                // never report more than what was really observed
+                return static_cast<float>(std::min(highestEquivalentOf(i), _maxMicros)) * 1e-6F;
+            }
+        }
+        return getMax();
+    }
+
+    /***** Timer *****/
+
     void Timer::setupTimerWithInterval(float seconds, unsigned int repeat, float delay) {
         _elapsed = -1;
         _interval = seconds;
@@ -43,6 +113,10 @@ namespace cc {
     }
 
     void Timer::update(float dt) {
+        if (_idle) {
+            return;
+        }
+
         if (_elapsed == -1) {
             _elapsed = 0;
             _timesExecuted = 0;
@@ -57,8 +131,9 @@ namespace cc {
             if (_elapsed < _delay) {
                 return;
             }
-            trigger(_delay);
+            // consume the time before the callback, which may re-arm the timer
             _elapsed = _elapsed - _delay;
+            fire(_elapsed, _delay);
             _timesExecuted += 1;
             _useDelay = false;
             // after delay, the rest time should compare with interval
@@ -71,8 +146,8 @@ namespace cc {
         // if _interval == 0, should trigger once every frame
         float interval = (_interval > 0) ? _interval : _elapsed;
         while (_elapsed >= interval) {
-            trigger(interval);
             _elapsed -= interval;
+            fire(_elapsed, interval);
             _timesExecuted += 1;
 
             if (!_runForever && _timesExecuted > _repeat) {
@@ -80,7 +155,7 @@ namespace cc {
                 break;
             }
 
-            if (_elapsed <= 0.F) {
+            if (_elapsed <= 0.F || _idle) {
                 break;
             }
 
@@ -90,6 +165,68 @@ namespace cc {
         }
     }
 
+    float Timer::getTimeToNextTrigger() const {
+        if (_idle || isDone()) {
+            return std::numeric_limits<float>::infinity();
+        }
+        float elapsed = _elapsed == -1 ? 0.F : _elapsed;
+        if (_useDelay) {
+            return std::max(_delay - elapsed, 0.F);
+        }
+        if (_interval <= 0.F) {
+            return 0.F;
+        }
+        return std::max(_interval - elapsed, 0.F);
+    }
+
+    void Timer::elapse(float dt) {
+        if (_elapsed == -1) {
+            _elapsed = 0;
+            _timesExecuted = 0;
+        }
+        if (_idle || isDone() || isEveryFrame()) {
+            return;
+        }
+        _elapsed = std::min(_elapsed + dt, _useDelay ? _delay : _interval);
+    }
+
+    void Timer::fireNext() {
+        if (_idle || isDone() || isEveryFrame()) {
+            return;
+        }
+        if (_elapsed == -1) {
+            _timesExecuted = 0;
+        }
+        // landing exactly on the deadline makes update() fire once with no lateness
+        _elapsed = _useDelay ? _delay : _interval;
+        update(0.F);
+    }
+
+    // the scheduler counts its timers where it removes them
+    Timer::~Timer() = default;
+
+    void Timer::fire(float lateness, float dt) {
+        if (willInvokeCallback()) {
+            onTrigger(lateness);
+        }
+        trigger(dt);
+    }
+
+    void Timer::onTrigger(float lateness) {
+        if (_scheduler == nullptr) {
+            return;
+        }
+        _scheduler->_triggersThisUpdate += 1;
+        if (!_scheduler->isLatencyTrackingEnabled()) {
+            return;
+        }
+        if (!_latency) {
+            _latency = std::make_unique<LatencyHistogram>();
+        }
+        _latency->record(lateness);
+        _scheduler->recordTimerLatency(_priority, lateness);
+    }
+
     // TimerTargetCallback
 
     bool TimerTargetCallback::initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, ISchedulable* target, const std::string& key, float seconds, uint32_t repeat, float delay) {
@@ -101,6 +238,10 @@ namespace cc {
         return true;
     }
 
+    void TimerTargetCallback::setupTimerWithInterval(float seconds, uint32_t repeat, float delay) {
+        Timer::setupTimerWithInterval(seconds, repeat, delay);
+    }
+
     void TimerTargetCallback::trigger(float dt) {
         if (_callback) {
             _callback(dt);
@@ -108,10 +249,109 @@ namespace cc {
     }
 
     void TimerTargetCallback::cancel() {
+        // repeat is exhausted, the scheduler removes the timer at the end of its update walk
+    }
+
+    // TimerTargetAsync
+
+    void TimerTargetAsync::setupTimerWithInterval(float seconds, uint32_t repeat, float delay) {
+        Timer::setupTimerWithInterval(seconds, repeat, delay);
+    }
+
+    bool TimerTargetAsync::initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& body, const ccSchedulerFunc& completion, ISchedulable* target, float seconds, uint32_t repeat, float delay) {
+        _scheduler = scheduler;
+        _target = target;
+        _body = body;
+        _completion = completion;
+        setupTimerWithInterval(seconds, repeat, delay);
+        return true;
+    }
+
+    void TimerTargetAsync::trigger(float dt) {
+        if (_body) {
+            _scheduler->_postAsync(_target, _body, _completion, dt);
+        }
+    }
+
+    void TimerTargetAsync::cancel() {
+        // repeat is exhausted, what was posted stays cancellable through the target's async state
+    }
+
+    // TimerTargetRearmable
+
+    void TimerTargetRearmable::setupTimerWithInterval(float seconds, uint32_t repeat, float delay) {
+        Timer::setupTimerWithInterval(seconds, repeat, delay);
+    }
+
+    bool TimerTargetRearmable::initWithCallback(Scheduler* scheduler, Mode mode, ISchedulable* target, const std::string& key) {
+        _scheduler = scheduler;
+        _target = target;
+        _mode = mode;
+        _key = key;
+        // idle timers never reach their repeat count, they are only removed by unschedule
+        setupTimerWithInterval(0.F, CC_REPEAT_FOREVER, 0.F);
+        _idle = true;
+        return true;
+    }
+
+    void TimerTargetRearmable::rearm(float seconds, const ccSchedulerFunc& callback, bool paused) {
+        _callback = callback;
+        _interval = seconds;
+        if (_mode == Mode::DEBOUNCE) {
+            _elapsed = 0.F;
+            _idle = false;
+            return;
+        }
+
+        if (!_idle) {
+            // inside the interval, remember the latest call for the trailing edge
+            _pending = true;
+            return;
+        }
+        _idle = false;
+        if (paused) {
+            // paused timers don't update, so the window is already due when they resume
+            _elapsed = _interval;
+            _pending = true;
+            return;
+        }
+        _elapsed = 0.F;
+        _pending = false;
+        if (_callback) {
+            // leading edge, fired right on time
+            onTrigger(0.F);
+            _callback(0.F);
+        }
+    }
+
+    bool TimerTargetRearmable::willInvokeCallback() const {
+        // a throttle window closing without a queued call only goes idle
+        return _mode == Mode::DEBOUNCE || _pending;
+    }
+
+    void TimerTargetRearmable::trigger(float dt) {
+        if (_mode == Mode::THROTTLE) {
+            if (!_pending) {
+                _idle = true;
+                return;
+            }
+            // trailing call, the next one has to wait a whole interval again
+            _pending = false;
+        } else {
+            _idle = true;
+        }
+        if (_callback) {
+            _callback(dt);
+        }
+    }
+
+    void TimerTargetRearmable::cancel() {
+        _idle = true;
     }
 
     /***** List Entry *****/
     std::vector<ListEntry*> ListEntry::_listEntries = std::vector<ListEntry*>();
+    PoolStats               ListEntry::_poolStats;
 
     ListEntry::ListEntry(ISchedulable* target, 
         Priority priority, 
@@ -130,6 +370,7 @@ namespace cc {
         bool paused, 
         bool markedForDeletion) {
         if (!_listEntries.empty()) {
+            _poolStats.hits += 1;
             ListEntry* result = _listEntries.back();
             _listEntries.pop_back();
             delete result->_target;
@@ -140,6 +381,7 @@ namespace cc {
             return result;
         }
         else {
+            _poolStats.misses += 1;
             ListEntry* result = new ListEntry(target, priority, paused, markedForDeletion);
             return result;
         }
@@ -149,17 +391,20 @@ namespace cc {
             delete entry->_target;
             entry->_target = nullptr;
             _listEntries.push_back(entry);
+        } else {
+            delete entry;
         }
     }
 
     /**** HashUpdateEntry ****/
 
     std::vector<HashUpdateEntry*> HashUpdateEntry::_hashUpdateEntries = std::vector<HashUpdateEntry*>();
+    PoolStats                     HashUpdateEntry::_poolStats;
 
     HashUpdateEntry::HashUpdateEntry(void* list, 
         ListEntry* entry, 
         ISchedulable* target, 
-        ccSchedulerFunc& callback) :
+        const ccSchedulerFunc& callback) :
         _list(list),
         _entry(entry),
         _target(target),
@@ -171,8 +416,9 @@ namespace cc {
     HashUpdateEntry* HashUpdateEntry::getFromPool(void* list,
         ListEntry* entry,
         ISchedulable* target,
-        ccSchedulerFunc& callback) {
+        const ccSchedulerFunc& callback) {
         if (!_hashUpdateEntries.empty()) {
+            _poolStats.hits += 1;
             HashUpdateEntry* result = _hashUpdateEntries.back();
             _hashUpdateEntries.pop_back();
             result->release();
@@ -182,6 +428,7 @@ namespace cc {
             result->_callback = callback;
             return result;
         } else {
+            _poolStats.misses += 1;
             return new HashUpdateEntry(list, entry, target, callback);
         }
         
@@ -191,6 +438,8 @@ namespace cc {
             entry->release();
             entry->_callback = nullptr;
             _hashUpdateEntries.push_back(entry);
+        } else {
+            delete entry;
         }
     }
     void HashUpdateEntry::release() {
@@ -198,6 +447,7 @@ namespace cc {
     }
     /**** HashTimerEntry ****/
     std::vector<HashTimerEntry *> HashTimerEntry::_hashTimerEntries = std::vector<HashTimerEntry *>();
+    PoolStats                     HashTimerEntry::_poolStats;
     HashTimerEntry::HashTimerEntry(std::vector<Timer*>& timers,
         ISchedulable* target,
         uint32_t timerIndex,
@@ -222,6 +472,9 @@ namespace cc {
             delete t;
         }
         _timers.clear();
+        for (auto& rearmables : _rearmables) {
+            rearmables.clear();
+        }
         
     }
     HashTimerEntry* HashTimerEntry::getFromPool(std::vector<Timer*>& timers,
@@ -232,27 +485,882 @@ namespace cc {
         bool paused) {
         if (!_hashTimerEntries.empty()) {
             //get from vector pool
+            _poolStats.hits += 1;
             auto result = _hashTimerEntries.back();
             _hashTimerEntries.pop_back();
             result->release();
             result->_timers = timers;
+            result->_target = target;
             result->_currentTimer = currentTimer;
             result->_timerIndex = timerIndex;
             result->_currentTimerSalvaged = currentTimerSalvaged;
             result->_paused = paused;
+            result->_markedForDeletion = false;
             return result;
         } else { 
-            return new HashTimerEntry();
+            _poolStats.misses += 1;
+            return new HashTimerEntry(timers, target, timerIndex, currentTimer, currentTimerSalvaged, paused);
         }
     }
     void HashTimerEntry::pushToPool(HashTimerEntry* entry) {
-        _hashTimerEntries.push_back(entry);
+        if (_hashTimerEntries.size() < MAX_POOL_SIZE) {
+            _hashTimerEntries.push_back(entry);
+        } else {
+            delete entry;
+        }
     }
     /***** Scheduler *****/
 
+    void Scheduler::update(float dt) {
+        float timeScale = getTimeScale();
+        if (timeScale != 1.F) {
+            dt *= timeScale;
+        }
+        // the ticks accumulate into these, stats() reports the whole update
+        std::fill(std::begin(_phaseSeconds), std::end(_phaseSeconds), 0.F);
+        if (!isLockstep()) {
+            _tick(dt);
+        } else {
+            _lockstepAccumulator += dt;
+            uint32_t steps = 0;
+            while (_lockstepAccumulator >= _lockstepStep && steps < _lockstepMaxSteps) {
+                _lockstepAccumulator -= _lockstepStep;
+                _tick(_lockstepStep);
+                _lockstepTick += 1;
+                steps += 1;
+            }
+            if (_lockstepAccumulator >= _lockstepStep) {
+                // too far behind, drop the backlog rather than spiral into ever longer updates
+                _lockstepAccumulator = std::fmod(_lockstepAccumulator, static_cast<double>(_lockstepStep));
+            }
+        }
+        // throttle leading edges called since the last update were counted too
+        _triggersLastUpdate = _triggersThisUpdate;
+        _triggersThisUpdate = 0;
+    }
+
+    void Scheduler::setLockstep(float step, uint32_t maxStepsPerUpdate) {
+        _lockstepStep = std::max(step, 0.F);
+        _lockstepMaxSteps = std::max<uint32_t>(maxStepsPerUpdate, 1);
+        _lockstepAccumulator = 0.0;
+        _lockstepTick = 0;
+    }
+
+    void Scheduler::_tick(float dt) {
+        using clock = std::chrono::steady_clock;
+        _updateHashLocked = true;
+        _currentTime += dt;
+
+        auto phaseStart = clock::now();
+        runFunctionsToBePerformedInCocosThread();
+        auto phaseEnd = clock::now();
+        _phaseSeconds[SchedulerStats::PERFORM_FUNCTIONS] += std::chrono::duration<float>(phaseEnd - phaseStart).count();
+
+        // Iterate over all the Updates' selectors, priority < 0, then == 0, then > 0
+        phaseStart = phaseEnd;
+        _updateAllLists(dt);
+        phaseEnd = clock::now();
+        _phaseSeconds[SchedulerStats::UPDATES] += std::chrono::duration<float>(phaseEnd - phaseStart).count();
+
+        // Iterate over all the custom selectors
+        phaseStart = phaseEnd;
+        _updateTimers(dt);
+        phaseEnd = clock::now();
+        _phaseSeconds[SchedulerStats::TIMERS] += std::chrono::duration<float>(phaseEnd - phaseStart).count();
+
+        _updateHashLocked = false;
+        _sweepMarkedEntries();
+    }
+
+    void Scheduler::_updateAllLists(float dt) {
+        // batches are walked alongside the entries, each runs after the entries of lower or equal priority
+        size_t batchIndex = 0;
+        _updateList(_updatesNegList, batchIndex, dt);
+        _updateBatchesBefore(batchIndex, 0, dt);
+        _updateList(_updates0List, batchIndex, dt);
+        _updateBatchesBefore(batchIndex, 1, dt);
+        _updateList(_updatesPosList, batchIndex, dt);
+        _updateBatchesBefore(batchIndex, INT64_MAX, dt);
+    }
+
+    void Scheduler::_updateList(std::vector<ListEntry*>& list, size_t& batchIndex, float dt) {
+        // entries scheduled by callbacks wait in _updateEntriesToAdd, so the list can't change under the loop
+        for (ListEntry* entry : list) {
+            _updateBatchesBefore(batchIndex, static_cast<int32_t>(entry->_priority), dt);
+            if (entry->_paused || entry->_markedForDeletion) {
+                continue;
+            }
+            HashUpdateEntry* element = entry->_target->_schedulerSlot.update;
+            if (element != nullptr && element->_callback) {
+                element->_callback(dt);
+            }
+        }
+    }
+
+    void Scheduler::_updateBatchesBefore(size_t& batchIndex, int64_t order, float dt) {
+        // batches scheduled by callbacks wait in _updateBatchesToAdd, unscheduled ones stay until the sweep
+        for (; batchIndex < _updateBatches.size(); ++batchIndex) {
+            UpdateBatchBase* batch = _updateBatches[batchIndex].get();
+            if (static_cast<int32_t>(batch->getPriority()) >= order) {
+                return;
+            }
+            if (!batch->_markedForDeletion) {
+                batch->dispatch(dt);
+            }
+        }
+    }
+
+    UpdateBatchBase* Scheduler::_addUpdateBatch(std::unique_ptr<UpdateBatchBase> batch) {
+        UpdateBatchBase* result = batch.get();
+        if (_updateHashLocked) {
+            // inserting would shift the batches being dispatched
+            _updateBatchesToAdd.push_back(std::move(batch));
+        } else {
+            _insertUpdateBatch(std::move(batch));
+        }
+        return result;
+    }
+
+    void Scheduler::_insertUpdateBatch(std::unique_ptr<UpdateBatchBase> batch) {
+        auto before = [](int32_t order, const std::unique_ptr<UpdateBatchBase>& other) { return order < static_cast<int32_t>(other->getPriority()); };
+        auto position = std::upper_bound(_updateBatches.begin(), _updateBatches.end(), static_cast<int32_t>(batch->getPriority()), before);
+        _updateBatches.insert(position, std::move(batch));
+    }
+
+    void Scheduler::_insertPendingUpdateBatches() {
+        for (auto& batch : _updateBatchesToAdd) {
+            if (!batch->_markedForDeletion) {
+                _insertUpdateBatch(std::move(batch));
+            }
+        }
+        _updateBatchesToAdd.clear();
+    }
+
+    void Scheduler::unscheduleUpdateBatch(UpdateBatchBase* batch) {
+        batch->_markedForDeletion = true;
+        if (_updateHashLocked) {
+            return;
+        }
+        auto isBatch = [batch](const std::unique_ptr<UpdateBatchBase>& other) { return other.get() == batch; };
+        _updateBatches.erase(std::remove_if(_updateBatches.begin(), _updateBatches.end(), isBatch), _updateBatches.end());
+    }
+
+    void Scheduler::_updateTimers(float dt) {
+        for (size_t i = 0; i < _arrayForTimers.size(); ++i) {
+            HashTimerEntry* element = _arrayForTimers[i];
+            if (element->_markedForDeletion) {
+                continue;
+            }
+            _currentTimer = element;
+            _currentTimerSalvaged = false;
+            if (element->_paused) {
+                continue;
+            }
+            // timers may be added by callbacks, so the size is read on every iteration
+            bool hasFinished = false;
+            for (element->_timerIndex = 0; element->_timerIndex < element->_timers.size(); ++element->_timerIndex) {
+                element->_currentTimer = element->_timers[element->_timerIndex];
+                element->_currentTimerSalvaged = false;
+                element->_currentTimer->update(dt);
+                hasFinished = hasFinished || element->_currentTimer->isDone();
+                element->_currentTimer = nullptr;
+                if (element->_markedForDeletion) {
+                    break;
+                }
+            }
+            if (hasFinished && !element->_markedForDeletion) {
+                _removeFinishedTimers(element);
+            }
+        }
+        _currentTimer = nullptr;
+    }
+
+    SchedulerStats Scheduler::stats() const {
+        SchedulerStats result;
+        result.updatesNeg = {_updateEntryCount[0], _pausedUpdates[0]};
+        result.updates0 = {_updateEntryCount[1], _pausedUpdates[1]};
+        result.updatesPos = {_updateEntryCount[2], _pausedUpdates[2]};
+        result.timers = _timerCount;
+        result.timerTargets = static_cast<uint32_t>(_arrayForTimers.size()) - _markedTimerEntries;
+        result.pausedTimerTargets = _pausedTimerTargets;
+        result.listEntryPool = ListEntry::getPoolStats();
+        result.hashUpdateEntryPool = HashUpdateEntry::getPoolStats();
+        result.hashTimerEntryPool = HashTimerEntry::getPoolStats();
+        result.triggersPerUpdate = _triggersLastUpdate;
+        std::copy(std::begin(_phaseSeconds), std::end(_phaseSeconds), std::begin(result.phaseSeconds));
+        return result;
+    }
+
+    void Scheduler::_addTimer(HashTimerEntry* element, Timer* timer) {
+        if (!_updateHashLocked) {
+            // scheduled between ticks its time starts now, during a tick the first update starts it
+            // since the dt of that tick already passed before it was scheduled
+            timer->elapse(0.F);
+        }
+        element->_timers.push_back(timer);
+        _timerCount += 1;
+        if (_fastForwarding && !element->_paused) {
+            _fastForwardTrack(element, timer);
+        }
+    }
+
+    void Scheduler::advanceTo(double time, float fixedStep) {
+        if (time <= _currentTime) {
+            return;
+        }
+        _updateHashLocked = true;
+        _fastForwarding = true;
+        for (HashTimerEntry* element : _arrayForTimers) {
+            if (element->_paused) {
+                continue;
+            }
+            for (Timer* timer : element->_timers) {
+                _fastForwardTrack(element, timer);
+            }
+        }
 
+        if (fixedStep > 0.F) {
+            while (_currentTime < time) {
+                double frameEnd = std::min(time, _currentTime + fixedStep);
+                auto   dt = static_cast<float>(frameEnd - _currentTime);
+                runFunctionsToBePerformedInCocosThread();
+                _fastForwardTimersTo(frameEnd);
+                _currentTime = frameEnd;
 
-    //Scheduler::Scheduler() {}
+                // entries scheduled during the previous step run from this one, like from the next tick
+                _insertPendingUpdateEntries();
+                _insertPendingUpdateBatches();
+                _updateAllLists(dt);
+                // callbacks may pause or unschedule targets, which erases from the live list, so walk a copy
+                std::vector<Timer*>          frameTimers = _fastForwardEveryFrame;
+                std::vector<HashTimerEntry*> finished;
+                for (Timer* timer : frameTimers) {
+                    auto iter = _fastForwardCursors.find(timer);
+                    if (iter == _fastForwardCursors.end()) {
+                        continue; // untracked by an earlier callback of this step
+                    }
+                    HashTimerEntry* element = iter->second.element;
+                    if (element->_paused || element->_markedForDeletion) {
+                        continue;
+                    }
+                    timer->update(dt);
+                    if (timer->isDone()) {
+                        finished.push_back(element);
+                    }
+                }
+                for (HashTimerEntry* element : finished) {
+                    if (!element->_markedForDeletion) {
+                        _removeFinishedTimers(element);
+                    }
+                }
+            }
+        } else {
+            _fastForwardTimersTo(time);
+            _currentTime = time;
+        }
+
+        // nothing is due before `time` any more, bring the timers which did not fire up to it
+        for (auto& pair : _fastForwardCursors) {
+            pair.first->elapse(static_cast<float>(time - pair.second.synced));
+        }
+        _fastForwardCursors.clear();
+        _fastForwardEvents.clear();
+        _fastForwardEveryFrame.clear();
+        // fires of a fast forward belong to no update
+        _triggersThisUpdate = 0;
+        _fastForwarding = false;
+        _updateHashLocked = false;
+        _sweepMarkedEntries();
+    }
+
+    void Scheduler::_fastForwardTrack(HashTimerEntry* element, Timer* timer) {
+        auto inserted = _fastForwardCursors.emplace(timer, FastForwardCursor{});
+        FastForwardCursor& cursor = inserted.first->second;
+        if (inserted.second) {
+            cursor.order = ++_fastForwardSerial;
+        }
+        cursor.element = element;
+        cursor.synced = _currentTime;
+        cursor.generation = ++_fastForwardSerial;
+
+        if (timer->isEveryFrame()) {
+            if (std::find(_fastForwardEveryFrame.begin(), _fastForwardEveryFrame.end(), timer) == _fastForwardEveryFrame.end()) {
+                _fastForwardEveryFrame.push_back(timer);
+            }
+            return;
+        }
+        float next = timer->getTimeToNextTrigger();
+        if (std::isfinite(next)) {
+            _fastForwardEvents.push_back({_currentTime + next, cursor.order, cursor.generation, timer});
+            std::push_heap(_fastForwardEvents.begin(), _fastForwardEvents.end(), std::greater<>());
+        }
+    }
+
+    void Scheduler::_fastForwardUntrack(HashTimerEntry* element) {
+        for (Timer* timer : element->_timers) {
+            if (_fastForwardCursors.erase(timer) > 0 && timer->isEveryFrame()) {
+                _fastForwardEveryFrame.erase(std::remove(_fastForwardEveryFrame.begin(), _fastForwardEveryFrame.end(), timer), _fastForwardEveryFrame.end());
+            }
+        }
+    }
+
+    void Scheduler::_fastForwardSetPaused(HashTimerEntry* element, bool paused) {
+        for (Timer* timer : element->_timers) {
+            if (!paused) {
+                _fastForwardTrack(element, timer);
+                continue;
+            }
+            auto iter = _fastForwardCursors.find(timer);
+            if (iter == _fastForwardCursors.end()) {
+                continue;
+            }
+            // freeze the timer where it is now, its pending events are dropped with the cursor
+            if (timer->isEveryFrame()) {
+                _fastForwardEveryFrame.erase(std::remove(_fastForwardEveryFrame.begin(), _fastForwardEveryFrame.end(), timer), _fastForwardEveryFrame.end());
+            } else {
+                timer->elapse(static_cast<float>(_currentTime - iter->second.synced));
+            }
+            _fastForwardCursors.erase(iter);
+        }
+    }
+
+    void Scheduler::_fastForwardTimersTo(double time) {
+        while (!_fastForwardEvents.empty() && _fastForwardEvents.front().deadline <= time) {
+            std::pop_heap(_fastForwardEvents.begin(), _fastForwardEvents.end(), std::greater<>());
+            FastForwardEvent event = _fastForwardEvents.back();
+            _fastForwardEvents.pop_back();
+
+            auto iter = _fastForwardCursors.find(event.timer);
+            if (iter == _fastForwardCursors.end() || iter->second.generation != event.generation) {
+                continue; // re-armed since this event was pushed
+            }
+            HashTimerEntry* element = iter->second.element;
+            if (element->_paused || element->_markedForDeletion) {
+                continue;
+            }
+            // after the fire the timer state is relative to its deadline
+            iter->second.synced = event.deadline;
+            _currentTime = std::max(_currentTime, event.deadline);
+            _currentTimer = element;
+            _currentTimerSalvaged = false;
+            element->_currentTimer = event.timer;
+            event.timer->fireNext();
+            element->_currentTimer = nullptr;
+            if (event.timer->isDone()) {
+                if (!element->_markedForDeletion) {
+                    _removeFinishedTimers(element);
+                }
+                continue;
+            }
+
+            // the callback may have re-armed this timer or added others, so look the cursor up again
+            iter = _fastForwardCursors.find(event.timer);
+            if (iter == _fastForwardCursors.end() || iter->second.generation != event.generation) {
+                continue;
+            }
+            if (event.timer->isEveryFrame()) {
+                _fastForwardEveryFrame.push_back(event.timer);
+                continue;
+            }
+            float next = event.timer->getTimeToNextTrigger();
+            if (std::isfinite(next)) {
+                _fastForwardEvents.push_back({event.deadline + next, event.order, event.generation, event.timer});
+                std::push_heap(_fastForwardEvents.begin(), _fastForwardEvents.end(), std::greater<>());
+            }
+        }
+        _currentTimer = nullptr;
+    }
+
+    void Scheduler::schedule(ccSchedulerFunc& callback, ISchedulable* target, uint32_t interval, uint32_t repeat, uint32_t delay, bool paused, Priority priority) {
+        HashTimerEntry* element = _getOrAddTimerEntry(target, paused);
+        auto* timer = new TimerTargetCallback();
+        timer->initWithCallback(this, callback, target, "", static_cast<float>(interval), repeat, static_cast<float>(delay));
+        timer->setPriority(priority);
+        _addTimer(element, timer);
+    }
+
+    void Scheduler::recordTimerLatency(Priority priority, float lateness) {
+        _latencyByPriority[priority].record(lateness);
+    }
+
+    const LatencyHistogram* Scheduler::getLatencyHistogram(Priority priority) const {
+        auto iter = _latencyByPriority.find(priority);
+        return iter != _latencyByPriority.end() ? &iter->second : nullptr;
+    }
+
+    void Scheduler::resetLatencyWindow() {
+        for (auto& pair : _latencyByPriority) {
+            pair.second.reset();
+        }
+        for (HashTimerEntry* element : _arrayForTimers) {
+            for (Timer* timer : element->_timers) {
+                timer->resetLatencyHistogram();
+            }
+        }
+    }
+
+
+
+    void Scheduler::unscheduleAllForTarget(ISchedulable* target) {
+        unscheduleAllForTargets(&target, 1);
+    }
+
+    void Scheduler::unscheduleAllForTargets(ISchedulable* const* targets, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (targets[i] != nullptr) {
+                _markTargetForDeletion(targets[i]);
+            }
+        }
+        _sweepIfDue();
+    }
+
+    void Scheduler::_sweepIfDue() {
+        if (_updateHashLocked) {
+            return;
+        }
+        // compacting is O(n), only do it once enough entries are dead to keep a single unschedule O(1) amortized
+        size_t updateEntries = _updatesNegList.size() + _updates0List.size() + _updatesPosList.size();
+        bool   timersDue = _markedTimerEntries > 0 && _markedTimerEntries * 2 >= _arrayForTimers.size();
+        bool   updatesDue = !_updateEntriesToRelease.empty() && _updateEntriesToRelease.size() * 2 >= updateEntries;
+        if (timersDue || updatesDue) {
+            _sweepMarkedEntries();
+        }
+    }
+
+    void Scheduler::_markTargetForDeletion(ISchedulable* target) {
+        SchedulerSlot& slot = target->_schedulerSlot;
+        if (slot.timers != nullptr) {
+            _markTimerEntryForDeletion(slot.timers);
+        }
+        if (slot.update != nullptr) {
+            _markUpdateEntryForDeletion(slot.update);
+        }
+        if (slot.async) {
+            // bodies in flight keep the state and see the flag, a target reusing the address starts without a limit
+            slot.async->cancelled.store(true);
+            slot.async.reset();
+        }
+        if (slot.batchEntries > 0) {
+            for (auto& batch : _updateBatches) {
+                batch->removeOwner(target);
+            }
+            for (auto& batch : _updateBatchesToAdd) {
+                batch->removeOwner(target);
+            }
+        }
+        _publishTargetState(target);
+    }
+
+    void Scheduler::_markUpdateEntryForDeletion(HashUpdateEntry* element) {
+        ListEntry* entry = element->_entry;
+        size_t index = _listIndexOf(entry->_priority);
+        _updateEntryCount[index] -= 1;
+        if (entry->_paused) {
+            _pausedUpdates[index] -= 1;
+        }
+        entry->_markedForDeletion = true;
+        element->_target->_schedulerSlot.update = nullptr;
+        _updateEntriesToRelease.push_back(element);
+    }
+
+    size_t Scheduler::_listIndexOf(Priority priority) {
+        auto order = static_cast<int32_t>(priority);
+        return order < 0 ? 0 : (order == 0 ? 1 : 2);
+    }
+
+    std::vector<ListEntry*>& Scheduler::_listAt(size_t index) {
+        return index == 0 ? _updatesNegList : (index == 1 ? _updates0List : _updatesPosList);
+    }
+
+    void Scheduler::_priorityIn(std::vector<ListEntry*>& pplist, ListEntry* listElement, Priority priority) {
+        // after the entries of the same priority, so they run in registration order
+        auto before = [](Priority value, const ListEntry* other) { return static_cast<int32_t>(value) < static_cast<int32_t>(other->_priority); };
+        pplist.insert(std::upper_bound(pplist.begin(), pplist.end(), priority, before), listElement);
+    }
+
+    void Scheduler::_appendIn(std::vector<ListEntry*>& pplist, ListEntry* listElement) {
+        pplist.push_back(listElement);
+    }
+
+    void Scheduler::_insertUpdateEntry(ListEntry* entry) {
+        size_t index = _listIndexOf(entry->_priority);
+        if (index == 1) {
+            _appendIn(_updates0List, entry);
+        } else {
+            _priorityIn(_listAt(index), entry, entry->_priority);
+        }
+    }
+
+    void Scheduler::_insertPendingUpdateEntries() {
+        for (ListEntry* entry : _updateEntriesToAdd) {
+            _insertUpdateEntry(entry);
+        }
+        _updateEntriesToAdd.clear();
+    }
+
+    void Scheduler::scheduleUpdate(const ccSchedulerFunc& callback, ISchedulable* target, Priority priority, bool paused) {
+        HashUpdateEntry* element = target->_schedulerSlot.update;
+        if (element != nullptr && element->_entry->_priority == priority) {
+            element->_callback = callback;
+            _setUpdateEntryPaused(element->_entry, paused);
+            _publishTargetState(target);
+            return;
+        }
+        if (element != nullptr) {
+            // another priority is another list, the old entry goes with the next sweep
+            _markUpdateEntryForDeletion(element);
+        }
+
+        size_t index = _listIndexOf(priority);
+        ListEntry* entry = ListEntry::getFromPool(target, priority, paused, false);
+        target->_schedulerSlot.update = HashUpdateEntry::getFromPool(&_listAt(index), entry, target, callback);
+        _updateEntryCount[index] += 1;
+        if (paused) {
+            _pausedUpdates[index] += 1;
+        }
+        if (_updateHashLocked) {
+            // inserting would shift the entries being updated
+            _updateEntriesToAdd.push_back(entry);
+        } else {
+            _insertUpdateEntry(entry);
+        }
+        _publishTargetState(target);
+    }
+
+    void Scheduler::unscheduleUpdate(ISchedulable* target) {
+        if (target->_schedulerSlot.update == nullptr) {
+            return;
+        }
+        _markUpdateEntryForDeletion(target->_schedulerSlot.update);
+        _publishTargetState(target);
+        _sweepIfDue();
+    }
+
+    void Scheduler::_setUpdateEntryPaused(ListEntry* entry, bool paused) {
+        if (entry->_paused == paused) {
+            return;
+        }
+        entry->_paused = paused;
+        uint32_t& count = _pausedUpdates[_listIndexOf(entry->_priority)];
+        count = paused ? count + 1 : count - 1;
+    }
+
+    void Scheduler::_setTimerEntryPaused(HashTimerEntry* element, bool paused) {
+        if (element->_paused == paused) {
+            return;
+        }
+        element->_paused = paused;
+        _pausedTimerTargets = paused ? _pausedTimerTargets + 1 : _pausedTimerTargets - 1;
+        if (_fastForwarding) {
+            _fastForwardSetPaused(element, paused);
+        }
+    }
+
+    void Scheduler::_markTimerEntryForDeletion(HashTimerEntry* element) {
+        // stats only count live entries, they drop out right away
+        _timerCount -= static_cast<uint32_t>(element->_timers.size());
+        if (element->_paused) {
+            _pausedTimerTargets -= 1;
+        }
+        element->_markedForDeletion = true;
+        element->_target->_schedulerSlot.timers = nullptr;
+        _markedTimerEntries += 1;
+        if (_fastForwarding) {
+            // their events are skipped by the element check, but every frame timers would keep running
+            _fastForwardUntrack(element);
+        }
+        if (element == _currentTimer) {
+            // stop the timer being updated from catching up, its timers go with the sweep
+            _currentTimerSalvaged = true;
+        } else if (!_updateHashLocked) {
+            // nothing runs them, free the timers now so async ones are cancelled right away
+            _releaseTimers(element);
+        }
+    }
+
+    void Scheduler::_removeFinishedTimers(HashTimerEntry* element) {
+        size_t kept = 0;
+        for (Timer* timer : element->_timers) {
+            if (!timer->isDone()) {
+                element->_timers[kept++] = timer;
+                continue;
+            }
+            if (_fastForwarding) {
+                _fastForwardCursors.erase(timer);
+                _fastForwardEveryFrame.erase(std::remove(_fastForwardEveryFrame.begin(), _fastForwardEveryFrame.end(), timer), _fastForwardEveryFrame.end());
+            }
+            _timerCount -= 1;
+            delete timer;
+        }
+        element->_timers.resize(kept);
+        if (kept == 0) {
+            // like unscheduling the timers, so the target no longer reports as scheduled
+            ISchedulable* target = element->_target;
+            _markTimerEntryForDeletion(element);
+            _publishTargetState(target);
+        }
+    }
+
+    void Scheduler::_publishTargetState(ISchedulable* target) {
+        const SchedulerSlot& slot = target->_schedulerSlot;
+        uint32_t state = 0;
+        if (slot.timers != nullptr || slot.update != nullptr) {
+            state |= SchedulerSlot::SCHEDULED;
+        }
+        if ((slot.timers != nullptr && slot.timers->_paused) || (slot.update != nullptr && slot.update->_entry->_paused)) {
+            state |= SchedulerSlot::PAUSED;
+        }
+        // both flags live in one word, so a single load always sees a consistent pair
+        target->_schedulerSlot.state.store(state, std::memory_order_release);
+    }
+
+    bool Scheduler::isTargetScheduled(ISchedulable* target) const {
+        return (target->_schedulerSlot.state.load(std::memory_order_acquire) & SchedulerSlot::SCHEDULED) != 0;
+    }
+
+    void Scheduler::pauseTarget(ISchedulable* target) {
+        SchedulerSlot& slot = target->_schedulerSlot;
+        if (slot.timers != nullptr) {
+            _setTimerEntryPaused(slot.timers, true);
+        }
+        if (slot.update != nullptr) {
+            _setUpdateEntryPaused(slot.update->_entry, true);
+        }
+        _publishTargetState(target);
+    }
+
+    void Scheduler::resumeTarget(ISchedulable* target) {
+        SchedulerSlot& slot = target->_schedulerSlot;
+        if (slot.timers != nullptr) {
+            _setTimerEntryPaused(slot.timers, false);
+        }
+        if (slot.update != nullptr) {
+            _setUpdateEntryPaused(slot.update->_entry, false);
+        }
+        _publishTargetState(target);
+    }
+
+    bool Scheduler::isTargetPaused(ISchedulable* target) const {
+        return (target->_schedulerSlot.state.load(std::memory_order_acquire) & SchedulerSlot::PAUSED) != 0;
+    }
+
+    void Scheduler::_releaseTimers(HashTimerEntry* element) {
+        for (Timer* timer : element->_timers) {
+            delete timer;
+        }
+        element->_timers.clear();
+        for (auto& rearmables : element->_rearmables) {
+            rearmables.clear();
+        }
+        element->_currentTimer = nullptr;
+    }
+
+    void Scheduler::_sweepMarkedEntries() {
+        _insertPendingUpdateEntries();
+        _insertPendingUpdateBatches();
+        auto isMarked = [](const std::unique_ptr<UpdateBatchBase>& batch) { return batch->_markedForDeletion; };
+        _updateBatches.erase(std::remove_if(_updateBatches.begin(), _updateBatches.end(), isMarked), _updateBatches.end());
+        if (_markedTimerEntries > 0) {
+            _markedTimerEntries = 0;
+            size_t kept = 0;
+            for (size_t i = 0; i < _arrayForTimers.size(); ++i) {
+                HashTimerEntry* element = _arrayForTimers[i];
+                if (!element->_markedForDeletion) {
+                    _arrayForTimers[kept++] = element;
+                    continue;
+                }
+                _releaseTimers(element);
+                // the target belongs to the caller, release() must not delete it when the entry is reused
+                element->_target = nullptr;
+                HashTimerEntry::pushToPool(element);
+            }
+            _arrayForTimers.resize(kept);
+        }
+
+        if (!_updateEntriesToRelease.empty()) {
+            for (std::vector<ListEntry*>* list : {&_updatesNegList, &_updates0List, &_updatesPosList}) {
+                size_t kept = 0;
+                for (size_t i = 0; i < list->size(); ++i) {
+                    ListEntry* entry = (*list)[i];
+                    if (!entry->_markedForDeletion) {
+                        (*list)[kept++] = entry;
+                        continue;
+                    }
+                    // the pools delete what the entries point to, none of it is theirs
+                    entry->_target = nullptr;
+                    ListEntry::pushToPool(entry);
+                }
+                list->resize(kept);
+            }
+            for (HashUpdateEntry* element : _updateEntriesToRelease) {
+                element->_list = nullptr;
+                element->_entry = nullptr;
+                element->_target = nullptr;
+                HashUpdateEntry::pushToPool(element);
+            }
+            _updateEntriesToRelease.clear();
+        }
+    }
+
+    HashTimerEntry* Scheduler::_getOrAddTimerEntry(ISchedulable* target, bool paused) {
+        if (target->_schedulerSlot.timers != nullptr) {
+            return target->_schedulerSlot.timers;
+        }
+        std::vector<Timer*> timers;
+        HashTimerEntry* element = HashTimerEntry::getFromPool(timers, target, 0, nullptr, false, paused);
+        if (paused) {
+            _pausedTimerTargets += 1;
+        }
+        target->_schedulerSlot.timers = element;
+        _arrayForTimers.push_back(element);
+        _publishTargetState(target);
+        return element;
+    }
+
+    void Scheduler::scheduleAsync(const ccSchedulerFunc& body, const ccSchedulerFunc& completion, ISchedulable* target, float interval, uint32_t repeat, float delay, bool paused, Priority priority) {
+        HashTimerEntry* element = _getOrAddTimerEntry(target, paused);
+        auto* timer = new TimerTargetAsync();
+        timer->initWithCallback(this, body, completion, target, interval, repeat, delay);
+        timer->setPriority(priority);
+        _addTimer(element, timer);
+    }
+
+    TimerTargetRearmable* Scheduler::_getOrAddRearmable(TimerTargetRearmable::Mode mode, ISchedulable* target, const std::string& key) {
+        HashTimerEntry* element = _getOrAddTimerEntry(target, false);
+        TimerTargetRearmable*& rearmable = element->_rearmables[static_cast<size_t>(mode)][key];
+        if (rearmable == nullptr) {
+            rearmable = new TimerTargetRearmable();
+            rearmable->initWithCallback(this, mode, target, key);
+            _addTimer(element, rearmable);
+        }
+        return rearmable;
+    }
+
+    void Scheduler::debounce(ISchedulable* target, const std::string& key, float delay, const ccSchedulerFunc& callback, Priority priority) {
+        TimerTargetRearmable* timer = _getOrAddRearmable(TimerTargetRearmable::Mode::DEBOUNCE, target, key);
+        timer->setPriority(priority);
+        _rearm(timer, delay, callback);
+    }
+
+    void Scheduler::throttle(ISchedulable* target, const std::string& key, float interval, const ccSchedulerFunc& callback, Priority priority) {
+        TimerTargetRearmable* timer = _getOrAddRearmable(TimerTargetRearmable::Mode::THROTTLE, target, key);
+        timer->setPriority(priority);
+        _rearm(timer, interval, callback);
+    }
+
+    void Scheduler::_rearm(TimerTargetRearmable* timer, float seconds, const ccSchedulerFunc& callback) {
+        auto iter = _fastForwarding ? _fastForwardCursors.find(timer) : _fastForwardCursors.end();
+        if (iter == _fastForwardCursors.end()) {
+            // paused targets are never tracked by a fast forward
+            timer->rearm(seconds, callback, timer->getTarget()->_schedulerSlot.timers->_paused);
+            return;
+        }
+        // catch up to the current fast forward time first, the new deadline is relative to it
+        HashTimerEntry* element = iter->second.element;
+        timer->elapse(static_cast<float>(_currentTime - iter->second.synced));
+        timer->rearm(seconds, callback, false);
+        _fastForwardTrack(element, timer);
+    }
+
+    void Scheduler::setAsyncConcurrencyLimit(ISchedulable* target, uint32_t limit) {
+        _asyncStateOf(target).limit = limit;
+    }
+
+    AsyncTargetState& Scheduler::_asyncStateOf(ISchedulable* target) {
+        std::shared_ptr<AsyncTargetState>& state = target->_schedulerSlot.async;
+        if (!state) {
+            state = std::make_shared<AsyncTargetState>();
+        }
+        return *state;
+    }
+
+    void Scheduler::setAsyncWorkerCount(uint32_t count) {
+        _asyncWorkerCount = count;
+    }
+
+    ThreadPool* Scheduler::_getAsyncPool() {
+        if (!_asyncPool) {
+            uint32_t count = _asyncWorkerCount;
+            if (count == 0) {
+                uint32_t hardware = std::thread::hardware_concurrency();
+                count = hardware > 1 ? hardware - 1 : 1;
+            }
+            _asyncPool = std::make_unique<ThreadPool>(count);
+        }
+        return _asyncPool.get();
+    }
+
+    void Scheduler::_postAsync(ISchedulable* target, const ccSchedulerFunc& body, const ccSchedulerFunc& completion, float dt) {
+        AsyncTargetState& state = _asyncStateOf(target);
+        if (state.limit > 0 && state.inFlight >= state.limit) {
+            return;
+        }
+        state.inFlight += 1;
+
+        // the task keeps the state alive, unscheduling the target only detaches it from the slot
+        std::shared_ptr<AsyncTargetState> shared = target->_schedulerSlot.async;
+        _getAsyncPool()->pushTask([this, shared, body, completion, dt]() {
+            if (!shared->cancelled.load()) {
+                body(dt);
+            }
+            performFunctionInCocosThread([shared, completion, dt]() {
+                shared->inFlight -= 1;
+                if (!shared->cancelled.load() && completion) {
+                    completion(dt);
+                }
+            });
+        });
+    }
+
+    void Scheduler::performFunctionInCocosThread(std::function<void()> function) {
+        std::lock_guard<std::mutex> lock(_performMutex);
+        _functionsToPerform.push_back(std::move(function));
+    }
+
+    void Scheduler::runFunctionsToBePerformedInCocosThread() {
+        std::vector<std::function<void()>> functions;
+        {
+            std::lock_guard<std::mutex> lock(_performMutex);
+            if (_functionsToPerform.empty()) {
+                return;
+            }
+            // functions beyond the cap are kept for the next tick so a burst can't stall one frame
+            auto count = std::min<size_t>(_functionsToPerform.size(), MAX_FUNC_TO_PERFORM);
+            auto last  = _functionsToPerform.begin() + static_cast<std::ptrdiff_t>(count);
+            functions.assign(std::make_move_iterator(_functionsToPerform.begin()), std::make_move_iterator(last));
+            _functionsToPerform.erase(_functionsToPerform.begin(), last);
+        }
+        for (auto& function : functions) {
+            function();
+        }
+    }
+
+    Scheduler::Scheduler() = default;
+
+    Scheduler::~Scheduler() {
+        // workers are joined before the timers are gone
+        _asyncPool.reset();
+        _insertPendingUpdateEntries();
+        std::vector<ISchedulable*> targets;
+        for (HashTimerEntry* element : _arrayForTimers) {
+            if (!element->_markedForDeletion) {
+                targets.push_back(element->_target);
+            }
+        }
+        for (std::vector<ListEntry*>* list : {&_updatesNegList, &_updates0List, &_updatesPosList}) {
+            for (ListEntry* entry : *list) {
+                if (!entry->_markedForDeletion) {
+                    targets.push_back(entry->_target);
+                }
+            }
+        }
+        _updateHashLocked = false;
+        _currentTimer = nullptr;
+        for (ISchedulable* target : targets) {
+            _markTargetForDeletion(target);
+        }
+        _sweepMarkedEntries();
+    }
     
 
 } // namespace cc
@@ -23,7 +23,10 @@
  THE SOFTWARE.
 ****************************************************************************/
 
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +36,50 @@ namespace cc {
 
 using ccSchedulerFunc = std::function<void(float)>;
 class Scheduler;
+class ThreadPool;
+
+/**
+ * @en
+ * Fixed bucket histogram (HDR style) of timer firing latency.<br>
+ * Values are recorded in microseconds, each power of two is split into 8 linear sub buckets,
+ * so the relative error of a quantile is below 12.5% whatever the magnitude.
+ * @zh
+ * 定时器触发延迟的固定桶直方图（HDR 风格）。<br>
+ * 以微秒记录，每个 2 的幂区间分为 8 个线性子桶，任意量级下分位数的相对误差都低于 12.5%。
+ * @class LatencyHistogram
+ */
+class CC_DLL LatencyHistogram final {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS{3};
+    static constexpr uint32_t SUB_BUCKET_COUNT{1U << SUB_BUCKET_BITS};
+    static constexpr uint32_t BUCKET_COUNT{(32 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT};
+
+    /** record one fire which happened `lateness` seconds after its deadline */
+    void record(float lateness);
+    /** clear all buckets, starts a new window */
+    void reset();
+
+    /**
+     * @en Returns the lateness in seconds under which `percentile` (0 ~ 1) of the fires happened.
+     * @zh 返回 `percentile`（0 ~ 1）比例的触发所低于的延迟，单位秒。
+     */
+    float getPercentile(float percentile) const;
+    inline float    getP50() const { return getPercentile(0.5F); }
+    inline float    getP99() const { return getPercentile(0.99F); }
+    inline float    getMax() const { return static_cast<float>(_maxMicros) * 1e-6F; }
+    inline uint64_t getCount() const { return _count; }
+
+    /** bucket a value in microseconds is counted in */
+    static uint32_t bucketIndexOf(uint32_t micros);
+    /** largest value in microseconds counted in the bucket, what percentiles report */
+    static uint32_t highestEquivalentOf(uint32_t index);
+
+private:
+    uint32_t _buckets[BUCKET_COUNT]{};
+    uint64_t _count{0};
+    uint32_t _maxMicros{0};
+};
+
 /**
 	 * @cond
 	 */
@@ -50,11 +97,41 @@ public:
 
     /** triggers the timer */
     void update(float dt);
+
+    /** seconds until the next fire, infinity once idle or done, 0 for timers firing every frame */
+    float getTimeToNextTrigger() const;
+    /** repeat is exhausted */
+    inline bool isDone() const { return !_runForever && _timesExecuted > _repeat; }
+    /** fires on every update instead of at deadlines */
+    inline bool isEveryFrame() const { return !_useDelay && _interval <= 0.F; }
+    /** lets time pass, stops right at the next deadline instead of firing it */
+    void elapse(float dt);
+    /** jumps to the next deadline and fires it exactly once */
+    void fireNext();
+
+    /** priority bucket the firing latency is accounted to */
+    inline Priority getPriority() const { return _priority; }
+    inline void     setPriority(Priority priority) { _priority = priority; }
+    /** latency of this timer, nullptr until it fired with latency tracking enabled */
+    inline const LatencyHistogram* getLatencyHistogram() const { return _latency.get(); }
+    inline void                    resetLatencyHistogram() {
+        if (_latency) {
+            _latency->reset();
+        }
+    }
 //protected dtor? Need to consider how to release space
     Timer() = default;
-    virtual ~Timer() = default; 
+    virtual ~Timer();
 protected:
+    // bookkeeping of every fire, `lateness` is how far past its deadline it happens
+    void onTrigger(float lateness);
+    // whether the next trigger() calls back, fires which don't are not counted
+    virtual bool willInvokeCallback() const { return true; }
+    // one deadline reached `lateness` ago, counts it then triggers
+    void fire(float lateness, float dt);
+
     Scheduler* _scheduler{nullptr};
+    Priority   _priority{Priority::LOW};
     float      _elapsed{0.f};
     bool       _runForever{false};
     bool       _useDelay{false};
@@ -62,6 +139,9 @@ protected:
     uint32_t   _repeat{0};
     float      _delay{0.f};
     float      _interval{0.f};
+    bool       _idle{false}; // stays registered but is skipped until re-armed
+
+    std::unique_ptr<LatencyHistogram> _latency;
 };
 
 class CC_DLL TimerTargetCallback final : public Timer {
@@ -83,6 +163,113 @@ private:
     std::string     _key;
 };
 
+/**
+ * @en
+ * Async bookkeeping of one target, held by its scheduler slot and by its bodies in flight.<br>
+ * Unscheduling the target sets `cancelled` and detaches the state from the slot, so the bodies still running
+ * see the flag and the target starts over with a fresh state and no limit.
+ * @zh
+ * 一个对象的异步状态，由其调度槽和正在执行的回调共同持有。<br>
+ * 取消对象的调度时会设置 `cancelled` 并将状态从调度槽上解除，仍在执行的回调可以看到该标记，
+ * 对象之后会使用新的、没有并发限制的状态。
+ */
+struct AsyncTargetState {
+    std::atomic<bool> cancelled{false}; // read by workers
+    uint32_t          inFlight{0};      // scheduler thread only
+    uint32_t          limit{0};         // 0 means unlimited
+};
+
+/**
+ * @en
+ * Timer whose body runs on the scheduler's worker pool.<br>
+ * The optional completion is posted back and invoked on the scheduler thread in a later tick.
+ * Unscheduling its target (`unscheduleAllForTarget(s)`) cancels the bodies which did not start yet and drops the completions,
+ * also those posted by timers which already ran out of repeats.
+ * @zh
+ * 回调在调度器工作线程池中执行的定时器。<br>
+ * 可选的完成回调会被投递回调度器线程，并在之后的某一帧执行。
+ * 取消其对象的调度（`unscheduleAllForTarget(s)`）时，尚未开始的回调会被取消，完成回调不会再执行，
+ * 重复次数已用完的定时器投递的回调也是如此。
+ */
+class CC_DLL TimerTargetAsync final : public Timer {
+public:
+    TimerTargetAsync() = default;
+    void setupTimerWithInterval(float interval, uint32_t repeat, float delay) override;
+    // Initializes a timer with a target, a body run on workers, a completion run on the scheduler thread, an interval in seconds, repeat in number of times to repeat, delay in seconds.
+    bool initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& body, const ccSchedulerFunc& completion, ISchedulable* target, float seconds, uint32_t repeat, float delay);
+
+    inline const ccSchedulerFunc& getBody() const { return _body; };
+    inline const ccSchedulerFunc& getCompletion() const { return _completion; };
+
+    void trigger(float dt) override;
+    void cancel() override;
+
+private:
+    ISchedulable*   _target{nullptr};
+    ccSchedulerFunc _body{nullptr};
+    ccSchedulerFunc _completion{nullptr};
+};
+
+/**
+ * @en
+ * Timer which is re-armed in place instead of being unscheduled and scheduled again.<br>
+ * DEBOUNCE fires once, `interval` seconds after the last re-arm.
+ * THROTTLE fires on the first re-arm, then at most once per `interval` with the latest callback.
+ * Once fired it goes idle but keeps its slot, so re-arming it never allocates.
+ * @zh
+ * 原地重新激活的定时器，无需取消后再重新添加。<br>
+ * DEBOUNCE（防抖）在最后一次激活 `interval` 秒后触发一次。
+ * THROTTLE（节流）在第一次激活时立即触发，之后每 `interval` 秒最多以最新的回调触发一次。
+ * 触发后进入空闲状态但保留其位置，重新激活不会分配内存。
+ */
+class CC_DLL TimerTargetRearmable final : public Timer {
+public:
+    enum class Mode : uint8_t {
+        DEBOUNCE,
+        THROTTLE,
+    };
+
+    TimerTargetRearmable() = default;
+    void setupTimerWithInterval(float interval, uint32_t repeat, float delay) override;
+    // Initializes an idle timer with a mode, a target and a key.
+    bool initWithCallback(Scheduler* scheduler, Mode mode, ISchedulable* target, const std::string& key);
+    // Restarts the countdown (debounce) or fires / queues the trailing call (throttle).
+    // While the target is paused the leading call is queued too, it fires on the first update after resume.
+    void rearm(float seconds, const ccSchedulerFunc& callback, bool paused);
+
+    inline Mode               getMode() const { return _mode; };
+    inline const std::string& getKey() const { return _key; };
+    inline ISchedulable*      getTarget() const { return _target; };
+    inline bool               isIdle() const { return _idle; };
+
+    void trigger(float dt) override;
+    void cancel() override;
+
+protected:
+    bool willInvokeCallback() const override;
+
+private:
+    ISchedulable*   _target{nullptr};
+    ccSchedulerFunc _callback{nullptr};
+    std::string     _key;
+    Mode            _mode{Mode::DEBOUNCE};
+    bool            _pending{false};
+};
+
+/**
+ * @en Hit and miss counters of an entry pool.
+ * @zh 条目对象池的命中与未命中计数。
+ */
+struct PoolStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+
+    inline float getHitRate() const {
+        uint64_t total = hits + misses;
+        return total > 0 ? static_cast<float>(hits) / static_cast<float>(total) : 0.F;
+    }
+};
+
 /**
  * @en A list double-linked list used for "updates with priority"
  * @zh 用于“优先更新”的列表
@@ -101,6 +288,7 @@ public:
 
     static ListEntry* getFromPool(ISchedulable* target, Priority priority, bool paused, bool markedForDeletion);
     static void       pushToPool(ListEntry* entry);
+    static inline const PoolStats& getPoolStats() { return _poolStats; }
     ~ListEntry();
 protected:
     ListEntry() {}
@@ -110,6 +298,7 @@ protected:
     
 private:
     static std::vector<ListEntry*> _listEntries;
+    static PoolStats               _poolStats;
 };
 
 /**
@@ -128,16 +317,18 @@ public:
     ISchedulable*   _target{nullptr};
     ccSchedulerFunc _callback{nullptr};
 
-    static HashUpdateEntry* getFromPool(void* list, ListEntry* entry, ISchedulable* target, ccSchedulerFunc& callback);
+    static HashUpdateEntry* getFromPool(void* list, ListEntry* entry, ISchedulable* target, const ccSchedulerFunc& callback);
     static void             pushToPool(HashUpdateEntry* entry);
+    static inline const PoolStats& getPoolStats() { return _poolStats; }
     ~HashUpdateEntry();
 protected:
     HashUpdateEntry() {}
-    HashUpdateEntry(void* list, ListEntry* entry, ISchedulable* target, ccSchedulerFunc& callback);
+    HashUpdateEntry(void* list, ListEntry* entry, ISchedulable* target, const ccSchedulerFunc& callback);
    
     void release();
 private:
     static std::vector<HashUpdateEntry*> _hashUpdateEntries;
+    static PoolStats                     _poolStats;
 };
 
 /**
@@ -150,18 +341,22 @@ private:
  * @param currentTimer
  * @param currentTimerSalvaged
  * @param paused
+ * @param rearmables debounce and throttle timers among `timers`, by mode then key
  */
 class HashTimerEntry final {
 public:
     std::vector<Timer*> _timers;
+    std::unordered_map<std::string, TimerTargetRearmable*> _rearmables[2];
     ISchedulable*       _target{nullptr};
     uint32_t            _timerIndex{0};
     Timer*              _currentTimer{nullptr};
     bool                _currentTimerSalvaged{false};
     bool                _paused{false};
+    bool                _markedForDeletion{false};
 
     static HashTimerEntry* getFromPool(std::vector<Timer*>& timers, ISchedulable* target, uint32_t timerIndex, Timer* currentTimer, bool currentTimerSalvaged, bool paused);
     static void            pushToPool(HashTimerEntry* entry);
+    static inline const PoolStats& getPoolStats() { return _poolStats; }
     ~HashTimerEntry();
 protected:
     HashTimerEntry() {}
@@ -170,6 +365,292 @@ protected:
     void release();
 private:
     static std::vector<HashTimerEntry*> _hashTimerEntries;
+    static PoolStats                    _poolStats;
+};
+
+/**
+ * @en Contiguous view of the items of an update batch.
+ * @zh 批量更新中各项的连续视图。
+ */
+template <typename T>
+struct UpdateSpan {
+    T*     data{nullptr};
+    size_t size{0};
+
+    inline T* begin() const { return data; }
+    inline T* end() const { return data + size; }
+    inline T& operator[](size_t index) const { return data[index]; }
+};
+
+/**
+ * @en Identifies an item of an update batch, it stays valid while the item is moved around by removals.
+ * @zh 标识批量更新中的一项，删除其他项导致该项移动时句柄依然有效。
+ */
+struct UpdateBatchHandle {
+    uint32_t slot{UINT32_MAX};
+    uint32_t generation{0};
+};
+
+class CC_DLL UpdateBatchBase {
+public:
+    virtual ~UpdateBatchBase() = default;
+
+    inline Priority getPriority() const { return _priority; }
+    inline bool     isPaused() const { return _paused; }
+    inline void     setPaused(bool paused) { _paused = paused; }
+
+protected:
+    friend class Scheduler;
+    explicit UpdateBatchBase(Priority priority) : _priority(priority) {}
+    virtual void dispatch(float dt) = 0;
+    // removes the items added for `owner`, called when the owner is unscheduled
+    virtual void removeOwner(ISchedulable* owner) = 0;
+
+    Priority _priority{Priority::LOW};
+    bool     _paused{false};
+    bool     _markedForDeletion{false};
+};
+
+/**
+ * @en
+ * Update callback shared by many items of one type and priority, see `Scheduler::scheduleUpdateBatch`.<br>
+ * Items are stored by value in one contiguous array, add and remove are O(1), removal moves the last item into the hole.
+ * An item added for an owner is removed when the owner is unscheduled with `unscheduleAllForTarget(s)`.
+ * Adds and removes made while the callback runs are applied right after it, adds first.
+ * @zh
+ * 同一类型、同一优先级的多个项共享的 update 回调，见 `Scheduler::scheduleUpdateBatch`。<br>
+ * 各项按值保存在一个连续数组中，添加和删除均为 O(1)，删除时把最后一项移到空位。
+ * 为某个所有者添加的项会在该所有者通过 `unscheduleAllForTarget(s)` 取消调度时被删除。
+ * 回调执行期间的添加和删除会在回调结束后生效，先添加后删除。
+ */
+template <typename T>
+class UpdateBatch final : public UpdateBatchBase {
+public:
+    using Callback = std::function<void(UpdateSpan<T> items, float dt)>;
+
+    UpdateBatch(Priority priority, const Callback& callback) : UpdateBatchBase(priority), _callback(callback) {}
+
+    ~UpdateBatch() override {
+        for (ISchedulable* owner : _owners) {
+            _releaseOwner(owner);
+        }
+        for (auto& pending : _pendingAdds) {
+            _releaseOwner(pending.owner);
+        }
+    }
+
+    /**
+     * @en Adds an item, owned by `owner` if it is not null.
+     * @zh 添加一项，`owner` 不为空时该项属于它。
+     * @param owner
+     * @param value
+     * @return The handle of the item.
+     */
+    UpdateBatchHandle add(ISchedulable* owner, T value) {
+        uint32_t slot = 0;
+        if (_freeSlots.empty()) {
+            slot = static_cast<uint32_t>(_slots.size());
+            _slots.emplace_back();
+        } else {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+        }
+        if (owner != nullptr) {
+            owner->_schedulerSlot.batchEntries += 1;
+            _slotsByOwner.emplace(owner, slot);
+        }
+        Slot& entry = _slots[slot];
+        if (_dispatching) {
+            entry.index = static_cast<uint32_t>(_pendingAdds.size());
+            entry.pending = true;
+            _pendingAdds.push_back({std::move(value), owner, slot});
+        } else {
+            _append(std::move(value), owner, slot);
+        }
+        return {slot, entry.generation};
+    }
+
+    /**
+     * @en Removes an item, removing it again or with a stale handle does nothing.
+     * @zh 删除一项，重复删除或使用失效的句柄不做任何事。
+     * @param handle
+     */
+    void remove(UpdateBatchHandle handle) {
+        if (!contains(handle)) {
+            return;
+        }
+        if (_dispatching) {
+            _pendingRemoves.push_back(handle);
+            return;
+        }
+        Slot& entry = _slots[handle.slot];
+        ISchedulable* owner = _owners[entry.index];
+        _eraseAt(entry.index);
+        _unlinkOwner(owner, handle.slot);
+        _freeSlot(handle.slot);
+    }
+
+    /**
+     * @en Returns the item or null for a stale handle, the pointer is valid until the next add or remove.
+     * @zh 返回该项，句柄失效时返回空，指针在下一次添加或删除前有效。
+     * @param handle
+     */
+    T* get(UpdateBatchHandle handle) {
+        if (!contains(handle)) {
+            return nullptr;
+        }
+        const Slot& entry = _slots[handle.slot];
+        return entry.pending ? &_pendingAdds[entry.index].value : &_items[entry.index];
+    }
+
+    inline bool contains(UpdateBatchHandle handle) const {
+        return handle.slot < _slots.size() && _slots[handle.slot].generation == handle.generation && _slots[handle.slot].index != FREE;
+    }
+    inline size_t size() const { return _items.size(); }
+
+protected:
+    void dispatch(float dt) override {
+        if (_paused || _items.empty()) {
+            return;
+        }
+        _dispatching = true;
+        _callback(UpdateSpan<T>{_items.data(), _items.size()}, dt);
+        _dispatching = false;
+        for (auto& pending : _pendingAdds) {
+            _append(std::move(pending.value), pending.owner, pending.slot);
+        }
+        _pendingAdds.clear();
+        for (UpdateBatchHandle handle : _pendingRemoves) {
+            remove(handle);
+        }
+        _pendingRemoves.clear();
+    }
+
+    void removeOwner(ISchedulable* owner) override {
+        auto range = _slotsByOwner.equal_range(owner);
+        std::vector<UpdateBatchHandle> handles;
+        for (auto iter = range.first; iter != range.second; ++iter) {
+            handles.push_back({iter->second, _slots[iter->second].generation});
+        }
+        for (UpdateBatchHandle handle : handles) {
+            remove(handle);
+        }
+    }
+
+private:
+    static constexpr uint32_t FREE = UINT32_MAX;
+
+    struct Slot {
+        uint32_t index{FREE}; // into _items, or into _pendingAdds while pending
+        uint32_t generation{0};
+        bool     pending{false};
+    };
+    struct PendingAdd {
+        T             value;
+        ISchedulable* owner;
+        uint32_t      slot;
+    };
+
+    void _append(T&& value, ISchedulable* owner, uint32_t slot) {
+        _slots[slot].index = static_cast<uint32_t>(_items.size());
+        _slots[slot].pending = false;
+        _items.push_back(std::move(value));
+        _owners.push_back(owner);
+        _itemSlots.push_back(slot);
+    }
+
+    void _eraseAt(uint32_t index) {
+        uint32_t last = static_cast<uint32_t>(_items.size() - 1);
+        if (index != last) {
+            _items[index] = std::move(_items[last]);
+            _owners[index] = _owners[last];
+            _itemSlots[index] = _itemSlots[last];
+            _slots[_itemSlots[index]].index = index;
+        }
+        _items.pop_back();
+        _owners.pop_back();
+        _itemSlots.pop_back();
+    }
+
+    void _unlinkOwner(ISchedulable* owner, uint32_t slot) {
+        if (owner == nullptr) {
+            return;
+        }
+        auto range = _slotsByOwner.equal_range(owner);
+        for (auto iter = range.first; iter != range.second; ++iter) {
+            if (iter->second == slot) {
+                _slotsByOwner.erase(iter);
+                break;
+            }
+        }
+        _releaseOwner(owner);
+    }
+
+    static void _releaseOwner(ISchedulable* owner) {
+        if (owner != nullptr) {
+            owner->_schedulerSlot.batchEntries -= 1;
+        }
+    }
+
+    void _freeSlot(uint32_t slot) {
+        _slots[slot].index = FREE;
+        _slots[slot].generation += 1;
+        _freeSlots.push_back(slot);
+    }
+
+    Callback _callback;
+    // parallel arrays, the callback only sees _items
+    std::vector<T>             _items;
+    std::vector<ISchedulable*> _owners;
+    std::vector<uint32_t>      _itemSlots;
+    // handle slot -> item index, reused through _freeSlots with a new generation
+    std::vector<Slot>     _slots;
+    std::vector<uint32_t> _freeSlots;
+
+    std::unordered_multimap<ISchedulable*, uint32_t> _slotsByOwner;
+    std::vector<PendingAdd>                         _pendingAdds;
+    std::vector<UpdateBatchHandle>                  _pendingRemoves;
+    bool                                            _dispatching{false};
+};
+
+/**
+ * @en
+ * Snapshot of the scheduler counters returned by `Scheduler::stats`.<br>
+ * Triggers and phase times are summed over the ticks of the last `update`, all lockstep steps included,
+ * and are zero when it ran none. Throttle leading edges called between updates count in the next one.
+ * The other counters are current. Entries unscheduled but not swept yet are not counted.
+ * @zh
+ * `Scheduler::stats` 返回的调度器计数快照。<br>
+ * 触发次数和各阶段耗时为最近一次 `update` 中所有帧（包括所有锁步步长）的总和，没有执行任何一帧时为 0。
+ * 两次 update 之间调用的节流首次触发计入下一次 update。其余计数均为当前值。
+ * 已取消但尚未清理的条目不计入。
+ */
+struct SchedulerStats {
+    enum Phase : uint32_t {
+        PERFORM_FUNCTIONS,
+        UPDATES,
+        TIMERS,
+        PHASE_COUNT,
+    };
+    struct ListStats {
+        uint32_t entries{0};
+        uint32_t paused{0};
+    };
+
+    ListStats updatesNeg;
+    ListStats updates0;
+    ListStats updatesPos;
+
+    uint32_t timers{0};
+    uint32_t timerTargets{0};
+    uint32_t pausedTimerTargets{0};
+
+    PoolStats listEntryPool;
+    PoolStats hashUpdateEntryPool;
+    PoolStats hashTimerEntryPool;
+
+    uint32_t triggersPerUpdate{0};
+    float    phaseSeconds[PHASE_COUNT]{};
 };
 
 /**
@@ -195,30 +676,126 @@ private:
  */
 class Scheduler final : public System {
 private:
-    float                  _timeScale{1.f};
+    std::atomic<float>     _timeScale{1.f};
     std::vector<ListEntry*> _updatesNegList;
     std::vector<ListEntry*> _updates0List;
     std::vector<ListEntry*> _updatesPosList;
 
-    std::unordered_map<void*, HashUpdateEntry*> _hashForUpdates;
-    std::unordered_map<void*, HashTimerEntry*>  _hashForTimers;
+    // sorted by priority compared as signed, then registration order
+    std::vector<std::unique_ptr<UpdateBatchBase>> _updateBatches;
+    // batches scheduled during a tick, inserted by the sweep
+    std::vector<std::unique_ptr<UpdateBatchBase>> _updateBatchesToAdd;
 
     //Old ts code for _currentTarget, _currentTargetSalved
-    HashTimerEntry*     _currentTimer{nullptr};
-    bool                _currentTimerSalvaged{false};
-    bool                _updateHashLocked{false};
-    std::vector<Timer*> _arrayForTimers;
+    HashTimerEntry*              _currentTimer{nullptr};
+    bool                         _currentTimerSalvaged{false};
+    bool                         _updateHashLocked{false};
+    std::vector<HashTimerEntry*> _arrayForTimers;
+
+    // unscheduled entries stay marked in their arrays, which are compacted in one sweep
+    // at the end of the tick or once half of them are marked
+    uint32_t                      _markedTimerEntries{0};
+    std::vector<HashUpdateEntry*> _updateEntriesToRelease;
+    // update entries scheduled during a tick, inserted into their list by the sweep
+    std::vector<ListEntry*> _updateEntriesToAdd;
+
+    bool                                           _latencyTracking{false};
+    std::unordered_map<Priority, LatencyHistogram> _latencyByPriority;
+
+    uint32_t _asyncWorkerCount{0};
+
+    std::mutex                         _performMutex;
+    std::vector<std::function<void()>> _functionsToPerform;
+
+    // counters behind stats(), the rest of the snapshot is read from the containers directly
+    uint32_t _timerCount{0};
+    uint32_t _triggersThisUpdate{0};
+    uint32_t _updateEntryCount[3]{}; // negative, zero and positive priority lists
+    uint32_t _pausedUpdates[3]{};
+    uint32_t _pausedTimerTargets{0};
+    uint32_t _triggersLastUpdate{0};
+    float    _phaseSeconds[SchedulerStats::PHASE_COUNT]{};
+
+    // fast forward: each timer is synced lazily, events of a re-armed timer are dropped by generation.
+    // Generations and orders both come from _fastForwardSerial, so they stay unique when a cursor is dropped and re-created
+    struct FastForwardCursor {
+        HashTimerEntry* element{nullptr};
+        double          synced{0.0};
+        uint64_t        generation{0};
+        uint64_t        order{0};
+    };
+    struct FastForwardEvent {
+        double   deadline;
+        uint64_t order;
+        uint64_t generation;
+        Timer*   timer;
+
+        inline bool operator>(const FastForwardEvent& other) const {
+            return deadline > other.deadline || (deadline == other.deadline && order > other.order);
+        }
+    };
+    double                                        _currentTime{0.0};
+    float                                         _lockstepStep{0.F};
+    uint32_t                                      _lockstepMaxSteps{0};
+    double                                        _lockstepAccumulator{0.0};
+    uint64_t                                      _lockstepTick{0};
+    bool                                          _fastForwarding{false};
+    uint64_t                                      _fastForwardSerial{0};
+    std::unordered_map<Timer*, FastForwardCursor> _fastForwardCursors;
+    std::vector<FastForwardEvent>                 _fastForwardEvents;
+    std::vector<Timer*>                           _fastForwardEveryFrame;
 
     //Previous: _removeHashElement, now: _removeTimerFromHash
     void _removeTimerFromHash(HashTimerEntry* element);
     void _removeUpdateFromHash(HashUpdateEntry* element);
     void _priorityIn(std::vector<ListEntry*>& pplist, ListEntry* listElement, Priority priority);
     void _appendIn(std::vector<ListEntry*>& pplist, ListEntry* listElement);
+    void                  _tick(float dt);
+    void                  _updateAllLists(float dt);
+    void                  _updateList(std::vector<ListEntry*>& list, size_t& batchIndex, float dt);
+    void                  _updateBatchesBefore(size_t& batchIndex, int64_t order, float dt);
+    static size_t         _listIndexOf(Priority priority);
+    std::vector<ListEntry*>& _listAt(size_t index);
+    void                  _insertUpdateEntry(ListEntry* entry);
+    void                  _insertPendingUpdateEntries();
+    void                  _markUpdateEntryForDeletion(HashUpdateEntry* element);
+    void                  _setUpdateEntryPaused(ListEntry* entry, bool paused);
+    void                  _setTimerEntryPaused(HashTimerEntry* element, bool paused);
+    void                  _sweepIfDue();
+    UpdateBatchBase*      _addUpdateBatch(std::unique_ptr<UpdateBatchBase> batch);
+    void                  _insertUpdateBatch(std::unique_ptr<UpdateBatchBase> batch);
+    void                  _insertPendingUpdateBatches();
+    void                  _updateTimers(float dt);
+    void                  _addTimer(HashTimerEntry* element, Timer* timer);
+    void                  _markTargetForDeletion(ISchedulable* target);
+    void                  _markTimerEntryForDeletion(HashTimerEntry* element);
+    void                  _removeFinishedTimers(HashTimerEntry* element);
+    static void           _publishTargetState(ISchedulable* target);
+    void                  _releaseTimers(HashTimerEntry* element);
+    void                  _sweepMarkedEntries();
+    void                  _rearm(TimerTargetRearmable* timer, float seconds, const ccSchedulerFunc& callback);
+    void                  _fastForwardTrack(HashTimerEntry* element, Timer* timer);
+    void                  _fastForwardSetPaused(HashTimerEntry* element, bool paused);
+    void                  _fastForwardUntrack(HashTimerEntry* element);
+    void                  _fastForwardTimersTo(double time);
+    HashTimerEntry*       _getOrAddTimerEntry(ISchedulable* target, bool paused);
+    TimerTargetRearmable* _getOrAddRearmable(TimerTargetRearmable::Mode mode, ISchedulable* target, const std::string& key);
+    ThreadPool*           _getAsyncPool();
+    static AsyncTargetState& _asyncStateOf(ISchedulable* target);
+    void                  _postAsync(ISchedulable* target, const ccSchedulerFunc& body, const ccSchedulerFunc& completion, float dt);
+    friend class Timer;
+    friend class TimerTargetAsync;
+
+    // declared last so that workers are joined before anything they post to is destroyed
+    std::unique_ptr<ThreadPool> _asyncPool;
 
 public:
     static void enableForTarget(ISchedulable* target);
     Scheduler();
-    ~Scheduler();
+    ~Scheduler() override;
+
+    void init() override {}
+    void postUpdate(float /*dt*/) override {}
     
 
     bool inline isCurrentTimerSalvaged() const { return _currentTimerSalvaged; }
@@ -240,8 +817,55 @@ public:
      * 注意：它影响该 Scheduler 下管理的所有定时器。
      * @param timeScale
      */
-    void inline setTimeScale(float t) { _timeScale = t; }
-    float inline getTimeScale() const { return _timeScale; }
+    void inline setTimeScale(float t) { _timeScale.store(t, std::memory_order_relaxed); }
+    /**
+     * @en Returns the time scale, may be called from any thread.
+     * @zh 返回时间缩放比例，可以在任意线程调用。
+     */
+    float inline getTimeScale() const { return _timeScale.load(std::memory_order_relaxed); }
+
+    /**
+     * @en
+     * Enables recording how late every timer fires relative to its deadline.<br>
+     * Each fire is accounted to the timer's own histogram and to the histogram of the priority it was scheduled with.
+     * @zh
+     * 开启定时器触发延迟统计，记录每次触发相对于预定时间的延迟。<br>
+     * 每次触发同时计入定时器自身和调度时指定的优先级对应的直方图。
+     * @param enabled
+     */
+    void inline setLatencyTrackingEnabled(bool enabled) { _latencyTracking = enabled; }
+    bool inline isLatencyTrackingEnabled() const { return _latencyTracking; }
+
+    /**
+     * @en Records the lateness of a fire, called by timers when latency tracking is enabled.
+     * @zh 记录一次触发的延迟，由开启延迟统计时的定时器调用。
+     */
+    void recordTimerLatency(Priority priority, float lateness);
+
+    /**
+     * @en Returns the latency histogram of the given priority, nullptr if no timer of it fired yet.
+     * @zh 返回指定优先级的延迟直方图，若该优先级还没有定时器触发则返回 nullptr。
+     * @param priority
+     */
+    const LatencyHistogram* getLatencyHistogram(Priority priority) const;
+
+    /**
+     * @en Clears the per priority and per timer latency histograms, starts a new window.
+     * @zh 清空所有优先级和定时器的延迟直方图，开始新的统计窗口。
+     */
+    void resetLatencyWindow();
+
+    /**
+     * @en
+     * Returns a snapshot of the scheduler counters: entries per update list, timers, paused counts,
+     * entry pool hit rates, triggers of the last tick and time spent in each phase of it.<br>
+     * Counters are maintained as the scheduler runs, reading them costs O(1).
+     * @zh
+     * 返回调度器计数快照：各 update 列表的条目数、定时器数、暂停数量、
+     * 条目对象池命中率、上一帧的触发次数以及各阶段耗时。<br>
+     * 计数在调度器运行时维护，读取的开销为 O(1)。
+     */
+    SchedulerStats stats() const;
 
     /**
      * @en 'update' the scheduler. (You should NEVER call this method, unless you know what you are doing.)
@@ -250,13 +874,70 @@ public:
      */
     void update(float dt);
 
+    /**
+     * @en Scheduler time in seconds, the sum of the scaled dt of every update and fast forward.
+     * @zh 调度器时间，单位秒，即所有 update 和快进经过的缩放后的时间之和。
+     */
+    double inline getCurrentTime() const { return _currentTime; }
+
+    /**
+     * @en
+     * Enables lockstep: `update` accumulates the frame dt and ticks the scheduler in fixed steps of 'step' seconds,
+     * at most 'maxStepsPerUpdate' times per update, the backlog beyond that is dropped.<br>
+     * Update entries and timers are always ticked in registration order, never in hash or pointer order,
+     * so the same schedule calls replay bit-identically whatever the frame dt are.
+     * Async timer completions are delivered at thread dependent ticks and are not covered.
+     * A 'step' of 0 turns lockstep off.
+     * @zh
+     * 开启帧同步模式：`update` 累加帧间隔，以 'step' 秒的固定步长驱动调度器，
+     * 每次 update 最多执行 'maxStepsPerUpdate' 步，超出的积压时间会被丢弃。<br>
+     * update 条目和定时器总是按注册顺序执行，与哈希和指针值无关，
+     * 因此相同的调度调用无论帧间隔如何都能得到逐位一致的结果。
+     * 异步定时器的完成回调的执行帧取决于线程，不在保证范围内。
+     * 'step' 为 0 时关闭帧同步模式。
+     * @param step
+     * @param [maxStepsPerUpdate=5]
+     */
+    void setLockstep(float step, uint32_t maxStepsPerUpdate = 5);
+    bool inline isLockstep() const { return _lockstepStep > 0.F; }
+    /** number of fixed steps run since lockstep was enabled, the current one while ticking */
+    uint64_t inline getLockstepTick() const { return _lockstepTick; }
+    /**
+     * @en Fraction of a step left in the accumulator, to interpolate rendering between the last two steps.
+     * @zh 累加器中剩余的步长比例，用于在最近两步之间插值渲染。
+     */
+    float inline getInterpolationAlpha() const { return isLockstep() ? static_cast<float>(_lockstepAccumulator / _lockstepStep) : 0.F; }
+
+    /**
+     * @en
+     * Advances scheduler time to 'time' by jumping from one timer deadline to the next, for headless simulation.<br>
+     * Timers fire in global deadline order, each with its own interval as dt, no empty frame is stepped.<br>
+     * With a 'fixedStep' above 0, update callbacks and every frame timers also run once per step, after the timers due in it.
+     * Without it they don't run at all.
+     * @zh
+     * 从一个定时器的触发时间直接跳到下一个，将调度器时间推进到 'time'，用于无界面的模拟。<br>
+     * 定时器按全局触发时间顺序触发，dt 为各自的间隔，不会执行空帧。<br>
+     * 'fixedStep' 大于 0 时，update 回调和每帧触发的定时器也会在每个步长内、到期的定时器之后执行一次，否则不执行。
+     * @param time Scheduler time to reach, see `getCurrentTime`.
+     * @param [fixedStep=0]
+     */
+    void advanceTo(double time, float fixedStep = 0.F);
+
+    /**
+     * @en Same as `advanceTo(getCurrentTime() + duration, fixedStep)`.
+     * @zh 等同于 `advanceTo(getCurrentTime() + duration, fixedStep)`。
+     * @param duration
+     * @param [fixedStep=0]
+     */
+    void inline fastForward(double duration, float fixedStep = 0.F) { advanceTo(_currentTime + duration, fixedStep); }
+
     /**
      * @en
      * <p>
      *   The scheduled method will be called every 'interval' seconds.<br/>
      *   If paused is YES, then it won't be called until it is resumed.<br/>
      *   If 'interval' is 0, it will be called every frame, but if so, it recommended to use 'scheduleUpdateForTarget:' instead.<br/>
-     *   If the callback function is already scheduled, then only the interval parameter will be updated without re-scheduling it again.<br/>
+     *   Every call adds a new timer, even if the callback is already scheduled for the target.<br/>
      *   repeat let the action be repeated repeat + 1 times, use `macro.REPEAT_FOREVER` to let the action run continuously<br/>
      *   delay is the amount of time the action will wait before it'll start<br/>
      * </p>
@@ -266,7 +947,7 @@ public:
      * 当时间间隔达到指定值时，设置的回调函数将会被调用。<br/>
      * 如果 interval 值为 0，那么回调函数每一帧都会被调用，但如果是这样，
      * 建议使用 scheduleUpdateForTarget 代替。<br/>
-     * 如果回调函数已经被定时器使用，那么只会更新之前定时器的时间间隔参数，不会设置新的定时器。<br/>
+     * 每次调用都会添加一个新的定时器，即使该回调函数已经在该对象上调度。<br/>
      * repeat 值可以让定时器触发 repeat + 1 次，使用 `macro.REPEAT_FOREVER`
      * 可以让定时器一直循环触发。<br/>
      * delay 值指定延迟时间，定时器会在延迟指定的时间之后开始计时。
@@ -276,22 +957,144 @@ public:
      * @param [repeat]
      * @param [delay=0]
      * @param [paused=fasle]
+     * @param [priority=Priority.LOW] Latency histogram the fires are accounted to.
      */
-    void schedule(ccSchedulerFunc& callback, ISchedulable* target, uint32_t interval, uint32_t repeat, uint32_t delay, bool paused = false);
+    void schedule(ccSchedulerFunc& callback, ISchedulable* target, uint32_t interval, uint32_t repeat, uint32_t delay, bool paused = false, Priority priority = Priority::LOW);
 
     /**
      * @en
      * Schedules the update callback for a given target,
-     * During every frame after schedule started, the "update" function of target will be invoked.
+     * During every frame after schedule started, the callback, usually the "update" function of target, will be invoked.<br>
+     * Lower priority values, compared as signed, run first. A target has one update callback,
+     * scheduling it again replaces the callback and the paused state.
+     * Scheduled while the scheduler ticks, it runs from the next tick.
      * @zh
      * 使用指定的优先级为指定的对象设置 update 定时器。<br>
-     * update 定时器每一帧都会被触发，触发时自动调用指定对象的 "update" 函数。<br>
-     * 优先级的值越低，定时器被触发的越早。
+     * update 定时器每一帧都会被触发，触发时调用指定的回调，通常是对象的 "update" 函数。<br>
+     * 优先级的值越低（按有符号数比较），定时器被触发的越早。一个对象只有一个 update 回调，再次设置会替换回调和暂停状态。
+     * 在调度器更新期间设置的 update 回调从下一帧开始执行。
+     * @param callback
      * @param target
      * @param priority
-     * @param paused
+     * @param [paused=false]
+     */
+    void scheduleUpdate(const ccSchedulerFunc& callback, ISchedulable* target, Priority priority, bool paused = false);
+
+    /**
+     * @en
+     * Registers one update callback for many items of type T with the same priority.<br>
+     * The callback is called once per frame with all the items added to the returned batch,
+     * stored contiguously by value, instead of once per target. Batches run among the update entries
+     * by priority, compared as signed, after the entries of the same priority.
+     * Scheduled while the scheduler ticks, a batch runs from the next tick.
+     * @zh
+     * 为多个类型为 T、优先级相同的项注册同一个 update 回调。<br>
+     * 回调每帧只调用一次，参数是添加到返回的批次中、按值连续存储的所有项，而不是每个目标调用一次。
+     * 批次按优先级（按有符号数比较）穿插在 update 条目之间执行，排在同优先级的条目之后。
+     * 在调度器更新期间注册的批次从下一帧开始执行。
+     * @param priority
+     * @param callback
+     * @return The batch to add targets to, owned by the scheduler until `unscheduleUpdateBatch`.
+     */
+    template <typename T>
+    UpdateBatch<T>* scheduleUpdateBatch(Priority priority, const typename UpdateBatch<T>::Callback& callback) {
+        return static_cast<UpdateBatch<T>*>(_addUpdateBatch(std::make_unique<UpdateBatch<T>>(priority, callback)));
+    }
+
+    /**
+     * @en Unschedules an update batch, it no longer runs and is destroyed at the latest at the end of the current update.
+     * @zh 取消一个批量 update，它不再执行，最迟会在当前 update 结束时被销毁。
+     * @param batch
+     */
+    void unscheduleUpdateBatch(UpdateBatchBase* batch);
+
+    /**
+     * @en
+     * Schedules a CPU heavy callback which runs on a worker thread every 'interval' seconds.<br/>
+     * The completion, if any, is invoked on the scheduler thread in a later tick with the same dt.<br/>
+     * Fires are skipped while the target already has `setAsyncConcurrencyLimit` bodies in flight.<br/>
+     * Unscheduling the target (`unscheduleAllForTarget`) cancels the pending bodies and drops their completions,
+     * also those of timers which already ran out of repeats.
+     * @zh
+     * 添加一个在工作线程中执行的定时器，适用于计算量大的回调。<br/>
+     * 如果指定了完成回调，它会在之后的某一帧于调度器线程中以相同的 dt 调用。<br/>
+     * 当目标正在执行的回调数达到 `setAsyncConcurrencyLimit` 的限制时，本次触发会被跳过。<br/>
+     * 取消目标的定时器（`unscheduleAllForTarget`）会取消尚未开始的回调，并丢弃其完成回调，
+     * 重复次数已用完的定时器的回调也是如此。
+     * @param body Invoked on a worker thread, must not touch scheduler state.
+     * @param completion Invoked on the scheduler thread, may be nullptr.
+     * @param target
+     * @param interval
+     * @param [repeat]
+     * @param [delay=0]
+     * @param [paused=fasle]
+     * @param [priority=Priority.LOW] Latency histogram the fires are accounted to.
+     */
+    void scheduleAsync(const ccSchedulerFunc& body, const ccSchedulerFunc& completion, ISchedulable* target, float interval, uint32_t repeat, float delay, bool paused = false, Priority priority = Priority::LOW);
+
+    /**
+     * @en Limits how many async bodies of the target may run at the same time, 0 means unlimited. Unscheduling the target clears it.
+     * @zh 限制指定对象同时执行的异步回调数量，0 表示不限制。取消对象的调度时该限制会被清除。
+     * @param target
+     * @param limit
      */
-    void scheduleUpdate(ISchedulable* target, Priority priority, bool paused);
+    void setAsyncConcurrencyLimit(ISchedulable* target, uint32_t limit);
+
+    /**
+     * @en
+     * Calls the callback once, 'delay' seconds after the last call with the same target and key.<br/>
+     * Calling it again before it fired only moves the deadline, the timer slot is reused.
+     * @zh
+     * 在以相同对象和 key 最后一次调用后的 'delay' 秒触发一次回调。<br/>
+     * 在触发前再次调用只会推迟触发时间，定时器会被复用。
+     * @param target
+     * @param key
+     * @param delay
+     * @param callback
+     * @param [priority=Priority.LOW] Latency histogram the fires are accounted to, the last call sets it.
+     */
+    void debounce(ISchedulable* target, const std::string& key, float delay, const ccSchedulerFunc& callback, Priority priority = Priority::LOW);
+
+    /**
+     * @en
+     * Calls the callback immediately, then at most once every 'interval' seconds for the same target and key.<br/>
+     * Calls inside the interval are collapsed into one trailing call with the latest callback.
+     * While the target is paused nothing is called, the call is made on the first update after it is resumed.
+     * @zh
+     * 立即调用回调，之后相同对象和 key 的回调每 'interval' 秒最多调用一次。<br/>
+     * 间隔内的多次调用会合并为一次，在间隔结束时以最新的回调执行。
+     * 对象暂停期间不会调用回调，而是在恢复后的第一次 update 中调用。
+     * @param target
+     * @param key
+     * @param interval
+     * @param callback
+     * @param [priority=Priority.LOW] Latency histogram the fires are accounted to, the last call sets it.
+     */
+    void throttle(ISchedulable* target, const std::string& key, float interval, const ccSchedulerFunc& callback, Priority priority = Priority::LOW);
+
+    /**
+     * @en
+     * Sets the number of worker threads for async timers, 0 picks one less than the hardware threads.<br/>
+     * The pool is created on the first async fire, later calls have no effect.
+     * @zh
+     * 设置异步定时器工作线程的数量，0 表示使用硬件线程数减一。<br/>
+     * 线程池在第一次异步触发时创建，之后的调用不再生效。
+     * @param count
+     */
+    void setAsyncWorkerCount(uint32_t count);
+
+    /**
+     * @en Posts a function to be invoked on the scheduler thread, can be called from any thread.
+     * @zh 投递一个在调度器线程中执行的函数，可以在任意线程调用。
+     * @param function
+     */
+    void performFunctionInCocosThread(std::function<void()> function);
+
+    /**
+     * @en Runs the functions posted by `performFunctionInCocosThread`, called at the beginning of `update`.
+     * @zh 执行 `performFunctionInCocosThread` 投递的函数，在 `update` 开始时调用。
+     */
+    void runFunctionsToBePerformedInCocosThread();
 
     /**
      * @en
@@ -315,12 +1118,27 @@ public:
     /**
      * @en
      * Unschedules all scheduled callbacks for a given target.
-     * This also includes the "update" callback.
-     * @zh 取消指定对象的所有定时器，包括 update 定时器。
+     * This also includes the "update" callback and the items it owns in update batches.
+     * @zh 取消指定对象的所有定时器，包括 update 定时器和它在批量 update 中拥有的项。
      * @param target The target to be unscheduled.
      */
     void unscheduleAllForTarget(ISchedulable* target);
 
+    /**
+     * @en
+     * Unschedules all scheduled callbacks of many targets, including their "update" callback and update batch items.<br/>
+     * Every target is marked in O(1) through its scheduler slot, then all entries are freed in a single sweep,
+     * use it instead of a loop over `unscheduleAllForTarget` when tearing down many targets.
+     * @zh
+     * 取消多个对象的所有定时器，包括 update 定时器和批量 update 中的项。<br/>
+     * 每个对象通过其调度槽以 O(1) 标记，然后在一次遍历中释放所有条目，
+     * 批量销毁对象时应使用此函数，而不是循环调用 `unscheduleAllForTarget`。
+     * @param targets
+     * @param count
+     */
+    void unscheduleAllForTargets(ISchedulable* const* targets, size_t count);
+    void inline unscheduleAllForTargets(const std::vector<ISchedulable*>& targets) { unscheduleAllForTargets(targets.data(), targets.size()); }
+
     /**
      * @en
      * Unschedules all scheduled callbacks from all targets including the system callbacks.<br/>
@@ -352,6 +1170,21 @@ public:
      */
     bool isScheduled(ccSchedulerFunc& callback, ISchedulable* target);
 
+    /**
+     * @en
+     * Checks whether a target has any timer or update callback scheduled.<br>
+     * Timers are removed once their repeat is exhausted, a target with only one-shot timers reports false after they fired.
+     * Debounce and throttle timers stay between calls, so they keep the target scheduled until it is unscheduled.<br>
+     * Lock free and safe to call from any thread while the scheduler updates, as long as the target is alive.
+     * @zh
+     * 检查指定对象是否有任何定时器或更新回调。<br>
+     * 定时器在重复次数用完后即被移除，只有一次性定时器的对象在其触发后返回 false。
+     * 防抖和节流定时器在两次调用之间依然保留，因此在取消调度前对象一直处于已调度状态。<br>
+     * 无锁，只要对象仍然有效，就可以在调度器更新的同时从任意线程调用。
+     * @param target
+     */
+    bool isTargetScheduled(ISchedulable* target) const;
+
     /**
      * @en
      * Pauses the target.<br/>
@@ -411,8 +1244,12 @@ public:
     void resumeTarget(ISchedulable* target);
 
     /**
-     * @en Returns whether or not the target is paused.
-     * @zh 返回指定对象的定时器是否处于暂停状态。
+     * @en
+     * Returns whether or not the target is paused.<br>
+     * Lock free and safe to call from any thread while the scheduler updates, as long as the target is alive.
+     * @zh
+     * 返回指定对象的定时器是否处于暂停状态。<br>
+     * 无锁，只要对象仍然有效，就可以在调度器更新的同时从任意线程调用。
      * @param target
      */
     bool isTargetPaused(ISchedulable* target) const;
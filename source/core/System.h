@@ -22,6 +22,9 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
 ****************************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 namespace cc {
 #define _USRDLL
@@ -39,9 +42,45 @@ namespace cc {
 #define CC_DLL
 #endif
 
+class HashTimerEntry;
+class HashUpdateEntry;
+struct AsyncTargetState;
+
+/**
+ * @en
+ * Handles to the target's entries, written by the scheduler only.<br>
+ * They make per target lookups and teardown free of hashing, so a target may be scheduled by one scheduler at a time
+ * and must stay alive until it is unscheduled. `state` mirrors them for lock free queries from other threads.
+ * @zh
+ * 指向目标调度条目的句柄，只由调度器写入。<br>
+ * 按目标查询和销毁都无需哈希查找，因此一个目标同一时间只能被一个调度器调度，并且在取消调度前必须保持有效。
+ * `state` 是它们的镜像，供其他线程无锁查询。
+ */
+struct SchedulerSlot {
+    enum State : uint32_t {
+        SCHEDULED = 1 << 0,
+        PAUSED    = 1 << 1,
+    };
+
+    HashTimerEntry*  timers{nullptr};
+    HashUpdateEntry* update{nullptr};
+    // items the target owns in update batches, unscheduling only visits the batches when it is not zero
+    uint32_t batchEntries{0};
+    // created by the first async timer or concurrency limit, shared with the bodies in flight
+    std::shared_ptr<AsyncTargetState> async;
+    // State flags republished by the scheduler whenever the entries change, the only field other threads may read
+    std::atomic<uint32_t> state{0};
+
+    SchedulerSlot() = default;
+    // a copied target is a new target, it is not scheduled
+    SchedulerSlot(const SchedulerSlot& /*other*/) {}
+    SchedulerSlot& operator=(const SchedulerSlot& /*other*/) { return *this; }
+};
+
 struct ISchedulable {
-    std::string id;
-    std::string uuid;
+    std::string   id;
+    std::string   uuid;
+    SchedulerSlot _schedulerSlot;
 };
 
 enum struct Priority : uint32_t {
@@ -0,0 +1,70 @@
+/****************************************************************************
+ Copyright (c) 2021 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated engine source code (the "Software"), a limited,
+ worldwide, royalty-free, non-assignable, revocable and non-exclusive license
+ to use Cocos Creator solely to develop games on your target platforms. You shall
+ not use Cocos Creator software for developing other software or tools that's
+ used for developing games. You are not granted to publish, distribute,
+ sublicense, and/or sell copies of Cocos Creator.
+
+ The software or tools in this License Agreement are licensed, not sold.
+ Xiamen Yaji Software Co., Ltd. reserves all rights not expressly granted to you.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+****************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cc {
+
+/**
+ * @en
+ * Fixed size pool of worker threads, tasks are run in the order they are pushed.<br>
+ * Pending tasks are dropped when the pool is destroyed, running ones are joined.
+ * @zh
+ * 固定大小的工作线程池，任务按推入顺序执行。<br>
+ * 线程池销毁时丢弃未执行的任务，并等待正在执行的任务结束。
+ * @class ThreadPool
+ */
+class ThreadPool final {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(uint32_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void pushTask(Task task);
+
+    inline uint32_t getThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> _threads;
+    std::deque<Task>         _tasks;
+    std::mutex               _mutex;
+    std::condition_variable  _condition;
+    bool                     _stop{false};
+};
+
+} // namespace cc